@@ -45,6 +45,7 @@ std::string GetDebugReportsLog(DebugActionFlags flags);
 #define kLayerSettingsProfileDirs "profile_dirs"
 #define kLayerSettingsProfileName "profile_name"
 #define kLayerSettingsProfileValidation "profile_validation"
+#define kLayerSettingsProfileCache "profile_cache"
 #define kLayerSettingsEmulatePortability "emulate_portability"
 #define kLayerSettings_constantAlphaColorBlendFactors "constantAlphaColorBlendFactors"
 #define kLayerSettings_events "events"
@@ -66,10 +67,13 @@ std::string GetDebugReportsLog(DebugActionFlags flags);
 #define kLayerSettingsDebugActions "debug_actions"
 #define kLayerSettingsDebugFilename "debug_filename"
 #define kLayerSettingsDebugFileClear "debug_file_clear"
+#define kLayerSettingsDebugBinaryFilename "debug_binary_filename"
 #define kLayerSettingsDebugFailOnError "debug_fail_on_error"
+#define kLayerSettingsDebugAsync "debug_async"
 #define kLayerSettingsDebugReports "debug_reports"
 #define kLayerSettingsExcludeDeviceExtensions "exclude_device_extensions"
 #define kLayerSettingsExcludeFormats "exclude_formats"
+#define kLayerSettingsImageFormatCacheSize "image_format_cache_size"
 #define kLayerSettingsDefaultFeatureValues "default_feature_values"
 #define kLayerSettingsUnknownFeatureValues "unknown_feature_values"
 
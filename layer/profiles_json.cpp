@@ -24,7 +24,9 @@
 #include <valijson/schema_parser.hpp>
 #include <valijson/validator.hpp>
 
-std::unique_ptr<valijson::Schema> schema;
+#include <filesystem>
+#include <iterator>
+#include <random>
 
 static Json::Value ParseJsonFile(std::string filename) {
     Json::Value root = Json::nullValue;
@@ -48,46 +50,83 @@ static Json::Value ParseJsonFile(std::string filename) {
     return root;
 }
 
-JsonValidator::~JsonValidator() { 
-    ::schema.reset();
+static bool GetFileStamp(const std::string &filename, std::uint64_t *file_size, std::int64_t *file_time) {
+    std::error_code error;
+    const std::uintmax_t size = std::filesystem::file_size(filename, error);
+    if (error) return false;
+    const auto time = std::filesystem::last_write_time(filename, error);
+    if (error) return false;
+
+    *file_size = static_cast<std::uint64_t>(size);
+    *file_time = static_cast<std::int64_t>(time.time_since_epoch().count());
+    return true;
 }
 
-bool JsonValidator::Init() {
+std::string GetProfilesSchemaFilename() {
 #ifdef __APPLE__
-    const std::string schema_path = "/usr/local/share/vulkan/registry/profiles-0.8-latest.json";
+    return "/usr/local/share/vulkan/registry/profiles-0.8-latest.json";
 #else
     const char *sdk_path = std::getenv("VULKAN_SDK");
-    if (sdk_path == nullptr) return false;
-    const std::string schema_path = std::string(sdk_path) + "/share/vulkan/registry/profiles-0.8-latest.json";
+    if (sdk_path == nullptr) return std::string();
+    return std::string(sdk_path) + "/share/vulkan/registry/profiles-0.8-latest.json";
 #endif
+}
+
+JsonValidator::~JsonValidator() {}
+
+bool JsonValidator::Init() {
+    const std::string schema_path = GetProfilesSchemaFilename();
+    if (schema_path.empty()) return false;
+
+    std::uint64_t file_size = 0;
+    std::int64_t file_time = 0;
+    if (!GetFileStamp(schema_path, &file_size, &file_time)) {
+        return false;
+    }
+
+    // The schema is only compiled again when the schema file is a different one or was modified
+    static std::mutex cache_mutex;
+    static std::string cache_path;
+    static std::uint64_t cache_size = 0;
+    static std::int64_t cache_time = 0;
+    static std::shared_ptr<const valijson::Schema> cache_schema;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
 
-    if (!schema) {
+    if (cache_schema == nullptr || cache_path != schema_path || cache_size != file_size || cache_time != file_time) {
         const Json::Value schema_document = ParseJsonFile(schema_path.c_str());
         if (schema_document == Json::nullValue) {
             return false;
         }
-        
-        schema.reset(new valijson::Schema);
+
+        std::shared_ptr<valijson::Schema> schema = std::make_shared<valijson::Schema>();
 
         valijson::SchemaParser parser;
         valijson::adapters::JsonCppAdapter schema_adapter(schema_document);
         parser.populateSchema(schema_adapter, *schema);
+
+        cache_path = schema_path;
+        cache_size = file_size;
+        cache_time = file_time;
+        cache_schema = std::move(schema);
     }
 
-    return schema.get() != nullptr;
+    schema_ = cache_schema;
+
+    return schema_ != nullptr;
 }
 
 bool JsonValidator::Check(const Json::Value &json_document) {
     assert(!json_document.empty());
 
-    if (schema.get() == nullptr) return true;
+    if (schema_ == nullptr) return true;
 
     valijson::Validator validator(valijson::Validator::kWeakTypes);
     valijson::adapters::JsonCppAdapter document_adapter(json_document);
 
     valijson::ValidationResults results;
 
-    if (!validator.validate(*schema, document_adapter, &results)) {
+    if (!validator.validate(*schema_, document_adapter, &results)) {
         valijson::ValidationResults::Error error;
         unsigned int error_num = 1;
         while (results.popError(error)) {
@@ -115,6 +154,143 @@ bool JsonValidator::Check(const Json::Value &json_document) {
     return true;
 }
 
+// Minimal JSON scanner used by ProbeProfilesSchema, it only tracks what is needed to skip the top-level member values
+struct JsonProbeScanner {
+    enum Result { SCAN_OK, SCAN_END_OF_BUFFER, SCAN_ERROR };
+
+    const char *cur;
+    const char *end;
+
+    void SkipWhitespaces() {
+        while (cur != end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r')) ++cur;
+    }
+
+    // Scan a string starting at the opening quote, the content is returned without the quotes and escapes are kept as is
+    Result ScanString(const char **begin, const char **last, bool *escaped) {
+        assert(*cur == '"');
+        *escaped = false;
+        *begin = ++cur;
+        while (cur != end) {
+            if (*cur == '\\') {
+                *escaped = true;
+                if (++cur == end) break;
+            } else if (*cur == '"') {
+                *last = cur++;
+                return SCAN_OK;
+            }
+            ++cur;
+        }
+        return SCAN_END_OF_BUFFER;
+    }
+
+    Result SkipValue() {
+        if (cur == end) return SCAN_END_OF_BUFFER;
+
+        const char *begin = nullptr;
+        const char *last = nullptr;
+        bool escaped = false;
+
+        if (*cur == '"') {
+            return ScanString(&begin, &last, &escaped);
+        }
+
+        if (*cur == '{' || *cur == '[') {
+            std::size_t depth = 0;
+            while (cur != end) {
+                if (*cur == '"') {
+                    const Result result = ScanString(&begin, &last, &escaped);
+                    if (result != SCAN_OK) return result;
+                    continue;
+                }
+                if (*cur == '/') {
+                    // Comments are accepted by the JsonCpp reader, leave them to the full parse
+                    return SCAN_ERROR;
+                }
+                if (*cur == '{' || *cur == '[') {
+                    ++depth;
+                } else if (*cur == '}' || *cur == ']') {
+                    if (--depth == 0) {
+                        ++cur;
+                        return SCAN_OK;
+                    }
+                }
+                ++cur;
+            }
+            return SCAN_END_OF_BUFFER;
+        }
+
+        // Numbers, true, false and null
+        const char *value_begin = cur;
+        while (cur != end && *cur != ',' && *cur != '}' && *cur != ']' && *cur != ' ' && *cur != '\t' && *cur != '\n' &&
+               *cur != '\r') {
+            ++cur;
+        }
+        if (cur == end) return SCAN_END_OF_BUFFER;
+        return cur == value_begin ? SCAN_ERROR : SCAN_OK;
+    }
+};
+
+JsonSchemaProbe ProbeProfilesSchema(const char *data, std::size_t size) {
+    static const char kProfilesSchema[] = "https://schema.khronos.org/vulkan/profiles";
+
+    JsonProbeScanner scanner{data, data + size};
+
+    // UTF-8 BOM
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        scanner.cur += 3;
+    }
+
+    scanner.SkipWhitespaces();
+    if (scanner.cur == scanner.end) return JSON_PROBE_INCOMPLETE;
+    if (*scanner.cur != '{') return JSON_PROBE_UNKNOWN;
+    ++scanner.cur;
+
+    while (true) {
+        scanner.SkipWhitespaces();
+        if (scanner.cur == scanner.end) return JSON_PROBE_INCOMPLETE;
+        if (*scanner.cur == '}') return JSON_PROBE_NOT_PROFILES;
+        if (*scanner.cur != '"') return JSON_PROBE_UNKNOWN;
+
+        const char *key_begin = nullptr;
+        const char *key_last = nullptr;
+        bool key_escaped = false;
+        if (scanner.ScanString(&key_begin, &key_last, &key_escaped) != JsonProbeScanner::SCAN_OK) return JSON_PROBE_INCOMPLETE;
+        if (key_escaped) return JSON_PROBE_UNKNOWN;
+
+        scanner.SkipWhitespaces();
+        if (scanner.cur == scanner.end) return JSON_PROBE_INCOMPLETE;
+        if (*scanner.cur != ':') return JSON_PROBE_UNKNOWN;
+        ++scanner.cur;
+        scanner.SkipWhitespaces();
+        if (scanner.cur == scanner.end) return JSON_PROBE_INCOMPLETE;
+
+        if (std::string(key_begin, key_last) == "$schema") {
+            if (*scanner.cur != '"') return JSON_PROBE_UNKNOWN;
+
+            const char *value_begin = nullptr;
+            const char *value_last = nullptr;
+            bool value_escaped = false;
+            if (scanner.ScanString(&value_begin, &value_last, &value_escaped) != JsonProbeScanner::SCAN_OK) {
+                return JSON_PROBE_INCOMPLETE;
+            }
+            if (value_escaped) return JSON_PROBE_UNKNOWN;
+
+            const std::string schema(value_begin, value_last);
+            return schema.find(kProfilesSchema) != std::string::npos ? JSON_PROBE_PROFILES : JSON_PROBE_NOT_PROFILES;
+        }
+
+        const JsonProbeScanner::Result result = scanner.SkipValue();
+        if (result == JsonProbeScanner::SCAN_END_OF_BUFFER) return JSON_PROBE_INCOMPLETE;
+        if (result == JsonProbeScanner::SCAN_ERROR) return JSON_PROBE_UNKNOWN;
+
+        scanner.SkipWhitespaces();
+        if (scanner.cur == scanner.end) return JSON_PROBE_INCOMPLETE;
+        if (*scanner.cur == '}') return JSON_PROBE_NOT_PROFILES;
+        if (*scanner.cur != ',') return JSON_PROBE_UNKNOWN;
+        ++scanner.cur;
+    }
+}
+
 bool WarnDuplicated(ProfileLayerSettings *layer_settings, const Json::Value &parent, const std::vector<std::string> &members) {
     assert(layer_settings != nullptr);
     
@@ -131,3 +307,337 @@ bool WarnDuplicated(ProfileLayerSettings *layer_settings, const Json::Value &par
     }
     return set.size() <= 1;
 }
+
+static const char kProfileCacheMagic[4] = {'V', 'P', 'C', 'H'};
+static const std::uint32_t kProfileCacheVersion = 2;
+static const std::uint32_t kProfileCacheMaxDepth = 256;
+
+enum ProfileCacheValueTag : std::uint8_t {
+    CACHE_VALUE_NULL = 0,
+    CACHE_VALUE_INT,
+    CACHE_VALUE_UINT,
+    CACHE_VALUE_REAL,
+    CACHE_VALUE_STRING,
+    CACHE_VALUE_FALSE,
+    CACHE_VALUE_TRUE,
+    CACHE_VALUE_ARRAY,
+    CACHE_VALUE_OBJECT,
+};
+
+template <typename T>
+static void WriteRaw(std::string &buffer, const T &value) {
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+static void WriteString(std::string &buffer, const std::string &value) {
+    WriteRaw(buffer, static_cast<std::uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+// Reading cursor over a cache buffer, every read fails instead of reading past the end of the buffer
+struct ProfileCacheReader {
+    const char *data;
+    std::size_t size;
+    std::size_t offset;
+
+    template <typename T>
+    bool ReadRaw(T *value) {
+        if (size - offset < sizeof(T)) return false;
+        std::memcpy(value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string *value) {
+        std::uint32_t length = 0;
+        if (!ReadRaw(&length)) return false;
+        if (size - offset < length) return false;
+        value->assign(data + offset, length);
+        offset += length;
+        return true;
+    }
+};
+
+static void EncodeValue(std::string &buffer, const Json::Value &value) {
+    switch (value.type()) {
+        default:
+        case Json::nullValue:
+            WriteRaw(buffer, CACHE_VALUE_NULL);
+            break;
+        case Json::intValue:
+            WriteRaw(buffer, CACHE_VALUE_INT);
+            WriteRaw(buffer, static_cast<std::int64_t>(value.asInt64()));
+            break;
+        case Json::uintValue:
+            WriteRaw(buffer, CACHE_VALUE_UINT);
+            WriteRaw(buffer, static_cast<std::uint64_t>(value.asUInt64()));
+            break;
+        case Json::realValue:
+            WriteRaw(buffer, CACHE_VALUE_REAL);
+            WriteRaw(buffer, value.asDouble());
+            break;
+        case Json::stringValue:
+            WriteRaw(buffer, CACHE_VALUE_STRING);
+            WriteString(buffer, value.asString());
+            break;
+        case Json::booleanValue:
+            WriteRaw(buffer, value.asBool() ? CACHE_VALUE_TRUE : CACHE_VALUE_FALSE);
+            break;
+        case Json::arrayValue:
+            WriteRaw(buffer, CACHE_VALUE_ARRAY);
+            WriteRaw(buffer, static_cast<std::uint32_t>(value.size()));
+            for (Json::ArrayIndex i = 0, n = value.size(); i < n; ++i) {
+                EncodeValue(buffer, value[i]);
+            }
+            break;
+        case Json::objectValue: {
+            WriteRaw(buffer, CACHE_VALUE_OBJECT);
+            WriteRaw(buffer, static_cast<std::uint32_t>(value.size()));
+            // Json::Value keeps the members sorted, so the order of the members is preserved
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                WriteString(buffer, it.name());
+                EncodeValue(buffer, *it);
+            }
+            break;
+        }
+    }
+}
+
+static bool DecodeValue(ProfileCacheReader &reader, Json::Value *value, std::uint32_t depth) {
+    if (depth > kProfileCacheMaxDepth) return false;
+
+    std::uint8_t tag = 0;
+    if (!reader.ReadRaw(&tag)) return false;
+
+    switch (tag) {
+        case CACHE_VALUE_NULL:
+            *value = Json::nullValue;
+            return true;
+        case CACHE_VALUE_INT: {
+            std::int64_t data = 0;
+            if (!reader.ReadRaw(&data)) return false;
+            *value = Json::Value(static_cast<Json::Int64>(data));
+            return true;
+        }
+        case CACHE_VALUE_UINT: {
+            std::uint64_t data = 0;
+            if (!reader.ReadRaw(&data)) return false;
+            *value = Json::Value(static_cast<Json::UInt64>(data));
+            return true;
+        }
+        case CACHE_VALUE_REAL: {
+            double data = 0.0;
+            if (!reader.ReadRaw(&data)) return false;
+            *value = Json::Value(data);
+            return true;
+        }
+        case CACHE_VALUE_STRING: {
+            std::string data;
+            if (!reader.ReadString(&data)) return false;
+            *value = Json::Value(data);
+            return true;
+        }
+        case CACHE_VALUE_FALSE:
+        case CACHE_VALUE_TRUE:
+            *value = Json::Value(tag == CACHE_VALUE_TRUE);
+            return true;
+        case CACHE_VALUE_ARRAY: {
+            std::uint32_t count = 0;
+            if (!reader.ReadRaw(&count)) return false;
+            // Each element takes at least one byte, reject counts that can't fit in the buffer
+            if (reader.size - reader.offset < count) return false;
+            *value = Json::Value(Json::arrayValue);
+            value->resize(count);
+            for (std::uint32_t i = 0; i < count; ++i) {
+                if (!DecodeValue(reader, &(*value)[i], depth + 1)) return false;
+            }
+            return true;
+        }
+        case CACHE_VALUE_OBJECT: {
+            std::uint32_t count = 0;
+            if (!reader.ReadRaw(&count)) return false;
+            *value = Json::Value(Json::objectValue);
+            for (std::uint32_t i = 0; i < count; ++i) {
+                std::string name;
+                if (!reader.ReadString(&name)) return false;
+                if (!DecodeValue(reader, &(*value)[name], depth + 1)) return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool JsonProfileCache::Load(const std::string &cache_filename, const std::string &schema_filename) {
+    entries_.clear();
+    dirty_ = false;
+
+    schema_filename_ = schema_filename;
+    schema_size_ = 0;
+    schema_time_ = 0;
+    const bool has_schema = !schema_filename.empty() && GetFileStamp(schema_filename, &schema_size_, &schema_time_);
+
+    std::ifstream file(cache_filename.c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ProfileCacheReader reader{buffer.data(), buffer.size(), 0};
+
+    char magic[sizeof(kProfileCacheMagic)] = {};
+    std::uint32_t version = 0;
+    std::string cache_schema_filename;
+    std::uint64_t cache_schema_size = 0;
+    std::int64_t cache_schema_time = 0;
+    std::uint32_t count = 0;
+    if (!reader.ReadRaw(&magic) || std::memcmp(magic, kProfileCacheMagic, sizeof(magic)) != 0 || !reader.ReadRaw(&version) ||
+        version != kProfileCacheVersion || !reader.ReadString(&cache_schema_filename) || !reader.ReadRaw(&cache_schema_size) ||
+        !reader.ReadRaw(&cache_schema_time) || !reader.ReadRaw(&count)) {
+        dirty_ = true;
+        return false;
+    }
+
+    // The validation results are only valid for the schema file they were checked against
+    const bool same_schema = has_schema && cache_schema_filename == schema_filename_ && cache_schema_size == schema_size_ &&
+                             cache_schema_time == schema_time_;
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::string filename;
+        Entry entry{};
+        std::uint8_t type = 0;
+        if (!reader.ReadString(&filename) || !reader.ReadRaw(&entry.file_size) || !reader.ReadRaw(&entry.file_time) ||
+            !reader.ReadRaw(&type) || type > ENTRY_VALIDATED_PROFILE || !reader.ReadString(&entry.encoded_root)) {
+            // Corrupted cache, it will be rebuilt from the profile files
+            entries_.clear();
+            dirty_ = true;
+            return false;
+        }
+        entry.type = static_cast<EntryType>(type);
+        if (entry.type == ENTRY_VALIDATED_PROFILE && !same_schema) {
+            entry.type = ENTRY_PROFILE;
+            dirty_ = true;
+        }
+        entries_[filename] = std::move(entry);
+    }
+
+    if (reader.offset != reader.size) {
+        entries_.clear();
+        dirty_ = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool JsonProfileCache::Save(const std::string &cache_filename) {
+    std::string buffer;
+    std::uint32_t count = 0;
+    WriteRaw(buffer, kProfileCacheMagic);
+    WriteRaw(buffer, kProfileCacheVersion);
+    WriteString(buffer, schema_filename_);
+    WriteRaw(buffer, schema_size_);
+    WriteRaw(buffer, schema_time_);
+    const std::size_t count_offset = buffer.size();
+    WriteRaw(buffer, count);
+
+    for (const auto &it : entries_) {
+        // Drop the entries of the profile files that were removed since the cache was created
+        std::uint64_t file_size = 0;
+        std::int64_t file_time = 0;
+        if (!GetFileStamp(it.first, &file_size, &file_time)) continue;
+
+        WriteString(buffer, it.first);
+        WriteRaw(buffer, it.second.file_size);
+        WriteRaw(buffer, it.second.file_time);
+        WriteRaw(buffer, static_cast<std::uint8_t>(it.second.type));
+        WriteString(buffer, it.second.encoded_root);
+        ++count;
+    }
+    std::memcpy(&buffer[count_offset], &count, sizeof(count));
+
+    // Write to a temporary file first so that a concurrent process never reads a partially written cache. Each save uses its
+    // own temporary file, so processes saving the cache at the same time don't write to the same file: the last rename wins.
+    std::random_device random;
+    const std::string tmp_filename = format("%s.%08x%08x.tmp", cache_filename.c_str(), random(), random());
+    {
+        std::ofstream file(tmp_filename.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!file.good()) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(tmp_filename, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmp_filename, cache_filename, error);
+    if (error) {
+        std::filesystem::remove(tmp_filename, error);
+        return false;
+    }
+
+    dirty_ = false;
+    return true;
+}
+
+bool JsonProfileCache::Find(const std::string &filename, EntryType *type, Json::Value *root) const {
+    assert(type != nullptr);
+    assert(root != nullptr);
+
+    const auto it = entries_.find(filename);
+    if (it == entries_.end()) {
+        return false;
+    }
+
+    std::uint64_t file_size = 0;
+    std::int64_t file_time = 0;
+    if (!GetFileStamp(filename, &file_size, &file_time)) {
+        return false;
+    }
+    if (it->second.file_size != file_size || it->second.file_time != file_time) {
+        return false;
+    }
+
+    *type = it->second.type;
+    if (it->second.type == ENTRY_NOT_A_PROFILE) {
+        *root = Json::nullValue;
+        return true;
+    }
+
+    ProfileCacheReader reader{it->second.encoded_root.data(), it->second.encoded_root.size(), 0};
+    if (!DecodeValue(reader, root, 0) || reader.offset != reader.size) {
+        *root = Json::nullValue;
+        return false;
+    }
+    return true;
+}
+
+void JsonProfileCache::Store(const std::string &filename, EntryType type, const Json::Value &root) {
+    std::uint64_t file_size = 0;
+    std::int64_t file_time = 0;
+    if (!GetFileStamp(filename, &file_size, &file_time)) {
+        return;
+    }
+
+    auto it = entries_.find(filename);
+    if (it != entries_.end() && it->second.type == type && it->second.file_size == file_size &&
+        it->second.file_time == file_time) {
+        return;
+    }
+
+    Entry &entry = entries_[filename];
+    entry.file_size = file_size;
+    entry.file_time = file_time;
+    entry.type = type;
+    entry.encoded_root.clear();
+    if (type != ENTRY_NOT_A_PROFILE) {
+        EncodeValue(entry.encoded_root, root);
+    }
+    dirty_ = true;
+}
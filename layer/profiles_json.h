@@ -19,11 +19,17 @@
 
 #pragma once
 #include <json/json.h>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "profiles_settings.h"
 
+namespace valijson {
+class Schema;
+}
+
 struct JsonValidator {
     JsonValidator(){}
     ~JsonValidator();
@@ -33,6 +39,60 @@ struct JsonValidator {
     bool Check(const Json::Value &json_document);
 
     std::string message;
+
+   private:
+    // Compiled schema shared by all the validators of the process, it is only read by Check
+    std::shared_ptr<const valijson::Schema> schema_;
 };
 
+// Path of the profiles schema used to validate the profile files, empty when the Vulkan SDK is not installed
+std::string GetProfilesSchemaFilename();
+
+// Binary cache of the profile files found in profile_file and profile_dirs, indexed by file path. An entry is only used when
+// the size and the last write time of the file are unchanged. The cache stores a binary re-encoding of the whole JSON
+// document: it saves the text parsing and the schema validation, the profiles are still resolved from the rebuilt
+// Json::Value on every load. The cache is machine-local: it is stored in native byte order.
+class JsonProfileCache {
+   public:
+    enum EntryType : uint8_t {
+        ENTRY_NOT_A_PROFILE = 0,  // JSON file without the Vulkan profiles $schema, ignored by the layer
+        ENTRY_PROFILE = 1,
+        ENTRY_VALIDATED_PROFILE = 2,  // Profile file already checked against the profiles schema
+    };
+
+    // The validated entries are only trusted when schema_filename is the schema file they were validated with and it was
+    // not modified since, otherwise they are reported as ENTRY_PROFILE to be validated again.
+    bool Load(const std::string &cache_filename, const std::string &schema_filename);
+    bool Save(const std::string &cache_filename);
+
+    bool Find(const std::string &filename, EntryType *type, Json::Value *root) const;
+    void Store(const std::string &filename, EntryType type, const Json::Value &root);
+
+    bool IsDirty() const { return dirty_; }
+
+   private:
+    struct Entry {
+        std::uint64_t file_size;
+        std::int64_t file_time;
+        EntryType type;
+        std::string encoded_root;
+    };
+
+    std::unordered_map<std::string, Entry> entries_;
+    std::string schema_filename_;
+    std::uint64_t schema_size_{0};
+    std::int64_t schema_time_{0};
+    bool dirty_{false};
+};
+
+enum JsonSchemaProbe {
+    JSON_PROBE_PROFILES,      // The top-level $schema member is a Vulkan profiles schema
+    JSON_PROBE_NOT_PROFILES,  // The top-level object has no $schema member or another schema
+    JSON_PROBE_INCOMPLETE,    // The buffer ended before the $schema member was found
+    JSON_PROBE_UNKNOWN,       // Unexpected JSON syntax, the document requires a full parse to report the error
+};
+
+// Scan the top-level members of a JSON document, without building it, until the $schema member is found
+JsonSchemaProbe ProbeProfilesSchema(const char *data, std::size_t size);
+
 bool WarnDuplicated(ProfileLayerSettings *layer_settings, const Json::Value &parent, const std::vector<std::string> &members);
@@ -20,32 +20,40 @@
 #include "profiles_settings.h"
 #include "profiles_util.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <string_view>
+#include <thread>
+
+static const std::size_t kLogMessageSize = 4096;
+
 void WarnMissingFormatFeatures(ProfileLayerSettings *layer_settings, const char *device_name, const std::string &format_name,
-                               const std::string &features, VkFormatFeatureFlags profile_features,
+                               const char *features, VkFormatFeatureFlags profile_features,
                                VkFormatFeatureFlags device_features) {
-    if (!(layer_settings->log.debug_reports & DEBUG_REPORT_WARNING_BIT)) {
+    if (!IsLogEnabled(layer_settings, DEBUG_REPORT_WARNING_BIT)) {
         return;
     }
 
     LogMessage(layer_settings, DEBUG_REPORT_WARNING_BIT,
                "For %s `%s`,\nthe Profile requires:\n\t\"%s\"\nbut the Device (%s) %s.\nThe "
                "`%s` can't be simulated on this Device.\n",
-               format_name.c_str(), features.c_str(), GetFormatFeatureString(profile_features).c_str(), device_name,
-               format_device_support_string(device_features).c_str(), features.c_str());
+               format_name.c_str(), features, GetFormatFeatureString(profile_features).c_str(), device_name,
+               format_device_support_string(device_features).c_str(), features);
 }
 
 void WarnMissingFormatFeatures2(ProfileLayerSettings *layer_settings, const char *device_name, const std::string &format_name,
-                                const std::string &features, VkFormatFeatureFlags2 profile_features,
+                                const char *features, VkFormatFeatureFlags2 profile_features,
                                 VkFormatFeatureFlags2 device_features) {
-    if (!(layer_settings->log.debug_reports & DEBUG_REPORT_WARNING_BIT)) {
+    if (!IsLogEnabled(layer_settings, DEBUG_REPORT_WARNING_BIT)) {
         return;
     }
 
     LogMessage(layer_settings, DEBUG_REPORT_WARNING_BIT,
                "For %s `%s`,\nthe Profile requires:\n\\t\"%s\"\nbut the Device (%s) %s.\nThe "
                "`%s` can't be simulated on this Device.\n",
-               format_name.c_str(), features.c_str(), GetFormatFeature2String(profile_features).c_str(), device_name,
-               format_device_support_string(device_features).c_str(), features.c_str());
+               format_name.c_str(), features, GetFormatFeature2String(profile_features).c_str(), device_name,
+               format_device_support_string(device_features).c_str(), features);
 }
 
 
@@ -102,51 +110,541 @@ const char *GetLogPrefix(DebugReportBits report) {
     }
 }
 
-void LogMessage(ProfileLayerSettings *layer_settings, DebugReportBits report, const char *message, ...) {
+static void WriteLogMessage(const ProfileLayerSettings *layer_settings, DebugReportBits report, const char *log) {
+    if (layer_settings->log.debug_actions & DEBUG_ACTION_STDOUT_BIT) {
 #if defined(__ANDROID__)
-    if (!layer_settings) return;
+        AndroidPrintf(report, log);
 #else
-    assert(layer_settings);
+        (void)report;
+        fprintf(stdout, "%s", log);
 #endif
+    }
 
-    if (!(layer_settings->log.debug_reports & report)) {
-        return;
+    if (layer_settings->log.debug_actions & DEBUG_ACTION_FILE_BIT) {
+        fprintf(layer_settings->log.profiles_log_file, "%s", log);
     }
 
-    std::size_t const STRING_BUFFER(4096);
+#if _WIN32
+    if (layer_settings->log.debug_actions & DEBUG_ACTION_OUTPUT_BIT) {
+        OutputDebugString(log);
+    }
+#endif  //_WIN32
+}
 
-    assert(message != nullptr);
-    assert(strlen(message) < STRING_BUFFER);
+// Bounded multi-producer single-consumer ring of formatted messages. The application threads claim a record with a
+// compare-and-swap on the write position, the writer thread is the only one to release the records. When the ring is
+// full, the application threads wait for the writer thread to release a record instead of dropping the message.
+class AsyncLogWriter {
+   public:
+    AsyncLogWriter(const ProfileLayerSettings *layer_settings) : layer_settings_(layer_settings), records_(kRecordCount) {
+        for (std::size_t i = 0; i < kRecordCount; ++i) {
+            records_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
 
-    char log[STRING_BUFFER];
-    snprintf(log, STRING_BUFFER, "%s", GetLogPrefix(report));
-    std::size_t len = std::strlen(log);
+    ~AsyncLogWriter() {
+        if (thread_.joinable()) {
+            stop_.store(true);
+            Wake();
+            thread_.join();
+        }
+    }
 
-    va_list list;
+    bool Start() {
+        try {
+            thread_ = std::thread(&AsyncLogWriter::Run, this);
+        } catch (const std::system_error &) {
+            return false;
+        }
+        return true;
+    }
 
-    va_start(list, message);
-    vsnprintf(log + len, STRING_BUFFER - len, message, list);
-    va_end(list);
+    void Push(DebugReportBits report, const char *log) {
+        std::size_t position = write_position_.load(std::memory_order_relaxed);
+        Record *record = nullptr;
+        while (record == nullptr) {
+            Record &candidate = records_[position % kRecordCount];
+            const std::size_t sequence = candidate.sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (write_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    record = &candidate;
+                }
+            } else if (sequence < position) {
+                // The ring is full, wait for the writer thread to release the record
+                WaitWritten(position + 1 - kRecordCount);
+                position = write_position_.load(std::memory_order_relaxed);
+            } else {
+                position = write_position_.load(std::memory_order_relaxed);
+            }
+        }
 
-    if (layer_settings->log.debug_actions & DEBUG_ACTION_STDOUT_BIT) {
+        record->report = report;
+        record->log.assign(log);
+        record->sequence.store(position + 1);
+        Wake();
+    }
+
+    // Wait until the messages pushed before the call are written
+    void Flush() { WaitWritten(write_position_.load(std::memory_order_acquire)); }
+
+   private:
+    static const std::size_t kRecordCount = 256;
+
+    struct Record {
+        std::atomic<std::size_t> sequence{0};
+        DebugReportBits report{DEBUG_REPORT_NOTIFICATION_BIT};
+        std::string log;  // Keeps its capacity between the uses of the record, sized by the actual messages
+    };
+
+    bool HasRecord() const {
+        const std::size_t position = read_position_.load(std::memory_order_relaxed);
+        return records_[position % kRecordCount].sequence.load() == position + 1;
+    }
+
+    bool WriteRecord() {
+        const std::size_t position = read_position_.load(std::memory_order_relaxed);
+        Record &record = records_[position % kRecordCount];
+        if (record.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+
+        WriteLogMessage(layer_settings_, record.report, record.log.c_str());
+
+        record.sequence.store(position + kRecordCount, std::memory_order_release);
+        read_position_.store(position + 1);
+
+        if (blocked_.load() > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            written_condition_.notify_all();
+        }
+        return true;
+    }
+
+    // Block until the record at 'position' is written. The counter of blocked threads is checked by the writer thread
+    // after it releases a record, and the released position is checked under the lock, so no notification is missed.
+    void WaitWritten(std::size_t position) {
+        if (read_position_.load() >= position) {
+            return;
+        }
+
+        blocked_.fetch_add(1);
+        Wake();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            written_condition_.wait(lock, [this, position]() { return read_position_.load() >= position; });
+        }
+        blocked_.fetch_sub(1);
+    }
+
+    void Wake() {
+        if (waiting_.load()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_condition_.notify_one();
+        }
+    }
+
+    void Run() {
+        for (;;) {
+            if (WriteRecord()) {
+                continue;
+            }
+            if (stop_.load()) {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            waiting_.store(true);
+            wake_condition_.wait(lock, [this]() { return stop_.load() || HasRecord(); });
+            waiting_.store(false);
+        }
+    }
+
+    const ProfileLayerSettings *layer_settings_;
+    std::vector<Record> records_;
+    std::atomic<std::size_t> write_position_{0};
+    std::atomic<std::size_t> read_position_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> waiting_{false};   // The writer thread waits for records
+    std::atomic<uint32_t> blocked_{0};  // Number of application threads waiting for written records
+    std::mutex mutex_;
+    std::condition_variable wake_condition_;
+    std::condition_variable written_condition_;
+    std::thread thread_;
+};
+
+// Binary log file, decoded by `vkprofiles log`. The messages are not formatted: each record stores the identifier of the
+// format string, the report type, a timestamp and the raw arguments. A format string is written once, in a definition
+// record that precedes its first message record. Unless debug_file_discard is set, the file is opened in append mode and
+// each session starts with its own header, the format identifiers are only valid until the next header. The file is
+// stored in native byte order:
+//   header:     "VPLB", uint32 version
+//   record:     uint32 kind, uint32 size of the record data
+//   definition: uint32 format id, format string
+//   message:    uint32 format id, uint32 report, int64 nanoseconds since epoch, arguments
+//   argument:   uint8 type, int64 | uint64 | double | uint64 pointer | uint32 length followed by the characters
+class BinaryLogWriter {
+   public:
+    enum RecordKind : uint32_t { RECORD_FORMAT = 0, RECORD_MESSAGE = 1 };
+    enum ArgumentType : uint8_t { ARGUMENT_INT = 0, ARGUMENT_UINT = 1, ARGUMENT_DOUBLE = 2, ARGUMENT_STRING = 3, ARGUMENT_POINTER = 4 };
+
+    ~BinaryLogWriter() {
+        if (file_ != nullptr) {
+            fclose(file_);
+        }
+    }
+
+    bool Open(const std::string &filename, bool discard) {
+        file_ = fopen(filename.c_str(), discard ? "wb" : "ab");
+        if (file_ == nullptr) {
+            return false;
+        }
+
+        const uint32_t version = kVersion;
+        fwrite("VPLB", 1, 4, file_);
+        fwrite(&version, sizeof(version), 1, file_);
+        return true;
+    }
+
+    void Write(DebugReportBits report, const char *message, va_list list) {
+        const int64_t timestamp =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        Payload payload;
+        payload.Append(&timestamp, sizeof(timestamp));
+        payload.reserved = CountArguments(message) * Payload::kArgumentSize;
+        PackArguments(message, list, &payload);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // The format strings are identified by their contents, the same format may be stored at different addresses
+        auto it = format_ids_.find(std::string_view(message));
+        if (it == format_ids_.end()) {
+            const std::string &format = formats_.emplace_back(message);
+            it = format_ids_.emplace(format, static_cast<uint32_t>(format_ids_.size())).first;
+            WriteRecord(RECORD_FORMAT, it->second, format.data(), format.size());
+        }
+
+        const uint32_t report_value = static_cast<uint32_t>(report);
+        const uint32_t size = static_cast<uint32_t>(sizeof(uint32_t) * 2 + payload.size);
+        const uint32_t header[] = {RECORD_MESSAGE, size, it->second, report_value};
+        fwrite(header, sizeof(header), 1, file_);
+        fwrite(payload.data, 1, payload.size, file_);
+    }
+
+    void Flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fflush(file_);
+    }
+
+   private:
+    static const uint32_t kVersion = 1;
+
+    struct Payload {
+        // Largest encoded argument other than a string, whose smallest encoding is shorter
+        static constexpr std::size_t kArgumentSize = 1 + sizeof(uint64_t);
+
+        void Append(const void *value, std::size_t value_size) {
+            if (value_size > kLogMessageSize - size) {
+                truncated = true;
+                return;
+            }
+            std::memcpy(data + size, value, value_size);
+            size += value_size;
+        }
+
+        void AppendArgument(ArgumentType type, const void *value, std::size_t value_size) {
+            reserved -= std::min(reserved, kArgumentSize);
+            if (truncated || 1 + value_size > kLogMessageSize - size) {
+                truncated = true;
+                return;
+            }
+            data[size++] = type;
+            Append(value, value_size);
+        }
+
+        void AppendString(const char *value) {
+            if (value == nullptr) {
+                value = "(null)";
+            }
+            // Long strings are cut to keep the record within the size of a formatted message, the room reserved for the
+            // following arguments is kept so that only the string is cut
+            reserved -= std::min(reserved, kArgumentSize);
+            const std::size_t available = kLogMessageSize - size - std::min(reserved, kLogMessageSize - size);
+            const std::size_t header_size = 1 + sizeof(uint32_t);
+            if (truncated || available < header_size) {
+                truncated = true;
+                return;
+            }
+            const uint32_t length = static_cast<uint32_t>(std::min(std::strlen(value), available - header_size));
+            data[size++] = ARGUMENT_STRING;
+            Append(&length, sizeof(length));
+            Append(value, length);
+        }
+
+        unsigned char data[kLogMessageSize];
+        std::size_t size{0};
+        std::size_t reserved{0};  // Size of the arguments that are not appended yet
+        bool truncated{false};
+    };
+
+    enum LengthModifier { LENGTH_NONE, LENGTH_HH, LENGTH_H, LENGTH_L, LENGTH_LL, LENGTH_J, LENGTH_Z, LENGTH_T, LENGTH_LONG_DOUBLE };
+
+    // Upper bound of the number of arguments read by PackArguments
+    static std::size_t CountArguments(const char *message) {
+        std::size_t count = 0;
+        for (const char *c = message; *c != '\0'; ++c) {
+            if (*c == '%' && c[1] == '%') {
+                ++c;
+            } else if (*c == '%' || *c == '*') {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    // Walk the conversion specifications of the format string to read the variadic arguments with their promoted types
+    static void PackArguments(const char *message, va_list list, Payload *payload) {
+        for (const char *c = message; *c != '\0'; ++c) {
+            if (*c != '%') {
+                continue;
+            }
+            ++c;
+            if (*c == '%') {
+                continue;
+            }
+
+            while (*c != '\0' && std::strchr("-+ #0", *c) != nullptr) {
+                ++c;
+            }
+            if (*c == '*') {
+                const int64_t width = va_arg(list, int);
+                payload->AppendArgument(ARGUMENT_INT, &width, sizeof(width));
+                ++c;
+            }
+            while (*c >= '0' && *c <= '9') {
+                ++c;
+            }
+            if (*c == '.') {
+                ++c;
+                if (*c == '*') {
+                    const int64_t precision = va_arg(list, int);
+                    payload->AppendArgument(ARGUMENT_INT, &precision, sizeof(precision));
+                    ++c;
+                }
+                while (*c >= '0' && *c <= '9') {
+                    ++c;
+                }
+            }
+
+            LengthModifier length = LENGTH_NONE;
+            switch (*c) {
+                case 'h':
+                    length = c[1] == 'h' ? LENGTH_HH : LENGTH_H;
+                    c += length == LENGTH_HH ? 2 : 1;
+                    break;
+                case 'l':
+                    length = c[1] == 'l' ? LENGTH_LL : LENGTH_L;
+                    c += length == LENGTH_LL ? 2 : 1;
+                    break;
+                case 'j':
+                    length = LENGTH_J;
+                    ++c;
+                    break;
+                case 'z':
+                    length = LENGTH_Z;
+                    ++c;
+                    break;
+                case 't':
+                    length = LENGTH_T;
+                    ++c;
+                    break;
+                case 'L':
+                    length = LENGTH_LONG_DOUBLE;
+                    ++c;
+                    break;
+                default:
+                    break;
+            }
+
+            switch (*c) {
+                case 'd':
+                case 'i': {
+                    int64_t value = 0;
+                    switch (length) {
+                        case LENGTH_L:
+                            value = va_arg(list, long);
+                            break;
+                        case LENGTH_LL:
+                            value = va_arg(list, long long);
+                            break;
+                        case LENGTH_J:
+                            value = va_arg(list, intmax_t);
+                            break;
+                        case LENGTH_Z:
+                            value = static_cast<int64_t>(va_arg(list, std::size_t));
+                            break;
+                        case LENGTH_T:
+                            value = va_arg(list, ptrdiff_t);
+                            break;
+                        default:
+                            value = va_arg(list, int);
+                            break;
+                    }
+                    payload->AppendArgument(ARGUMENT_INT, &value, sizeof(value));
+                    break;
+                }
+                case 'u':
+                case 'x':
+                case 'X':
+                case 'o': {
+                    uint64_t value = 0;
+                    switch (length) {
+                        case LENGTH_L:
+                            value = va_arg(list, unsigned long);
+                            break;
+                        case LENGTH_LL:
+                            value = va_arg(list, unsigned long long);
+                            break;
+                        case LENGTH_J:
+                            value = va_arg(list, uintmax_t);
+                            break;
+                        case LENGTH_Z:
+                            value = va_arg(list, std::size_t);
+                            break;
+                        case LENGTH_T:
+                            value = static_cast<uint64_t>(va_arg(list, ptrdiff_t));
+                            break;
+                        case LENGTH_HH:
+                            value = static_cast<unsigned char>(va_arg(list, unsigned int));
+                            break;
+                        case LENGTH_H:
+                            value = static_cast<unsigned short>(va_arg(list, unsigned int));
+                            break;
+                        default:
+                            value = va_arg(list, unsigned int);
+                            break;
+                    }
+                    payload->AppendArgument(ARGUMENT_UINT, &value, sizeof(value));
+                    break;
+                }
+                case 'c': {
+                    const int64_t value = va_arg(list, int);
+                    payload->AppendArgument(ARGUMENT_INT, &value, sizeof(value));
+                    break;
+                }
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A': {
+                    const double value =
+                        length == LENGTH_LONG_DOUBLE ? static_cast<double>(va_arg(list, long double)) : va_arg(list, double);
+                    payload->AppendArgument(ARGUMENT_DOUBLE, &value, sizeof(value));
+                    break;
+                }
+                case 's':
+                    payload->AppendString(va_arg(list, const char *));
+                    break;
+                case 'p': {
+                    const uint64_t value = reinterpret_cast<uintptr_t>(va_arg(list, void *));
+                    payload->AppendArgument(ARGUMENT_POINTER, &value, sizeof(value));
+                    break;
+                }
+                default:
+                    // Unknown conversion, the following arguments can't be read reliably
+                    return;
+            }
+        }
+    }
+
+    void WriteRecord(RecordKind kind, uint32_t id, const void *data, std::size_t size) {
+        const uint32_t header[] = {kind, static_cast<uint32_t>(sizeof(id) + size), id};
+        fwrite(header, sizeof(header), 1, file_);
+        fwrite(data, 1, size, file_);
+    }
+
+    std::mutex mutex_;
+    FILE *file_{nullptr};
+    std::deque<std::string> formats_;  // Storage of the format_ids_ keys, a deque doesn't move its elements
+    std::unordered_map<std::string_view, uint32_t> format_ids_;
+};
+
+ProfileLayerSettings::~ProfileLayerSettings() {
+    // Write the pending messages before the log file is closed
+    delete log.async_writer;
+    log.async_writer = nullptr;
+
+    delete log.binary_writer;
+    log.binary_writer = nullptr;
+
+    if (log.profiles_log_file != nullptr) {
+        fclose(log.profiles_log_file);
+        log.profiles_log_file = nullptr;
+    }
+}
+
+bool IsLogEnabled(const ProfileLayerSettings *layer_settings, DebugReportBits report) {
 #if defined(__ANDROID__)
-        AndroidPrintf(report, log);
+    if (!layer_settings) return false;
 #else
-        fprintf(stdout, "%s", log);
+    assert(layer_settings);
 #endif
+
+    if (!(layer_settings->log.debug_reports & report)) {
+        return false;
     }
 
-    if (layer_settings->log.debug_actions & DEBUG_ACTION_FILE_BIT) {
-        fprintf(layer_settings->log.profiles_log_file, "%s", log);
+    const DebugActionFlags text_actions = DEBUG_ACTION_FILE_BIT | DEBUG_ACTION_STDOUT_BIT | DEBUG_ACTION_OUTPUT_BIT;
+    return (layer_settings->log.debug_actions & (text_actions | DEBUG_ACTION_BREAKPOINT_BIT)) != 0 ||
+           layer_settings->log.binary_writer != nullptr;
+}
+
+void LogMessage(ProfileLayerSettings *layer_settings, DebugReportBits report, const char *message, ...) {
+    if (!IsLogEnabled(layer_settings, report)) {
+        return;
     }
 
-#if _WIN32
-    if (layer_settings->log.debug_actions & DEBUG_ACTION_OUTPUT_BIT) {
-        OutputDebugString(log);
+    assert(message != nullptr);
+    assert(strlen(message) < kLogMessageSize);
+
+    va_list list;
+    va_start(list, message);
+
+    if (layer_settings->log.binary_writer != nullptr) {
+        va_list binary_list;
+        va_copy(binary_list, list);
+        layer_settings->log.binary_writer->Write(report, message, binary_list);
+        va_end(binary_list);
+    }
+
+    // The message is only formatted when a text output requires it
+    if (layer_settings->log.debug_actions & (DEBUG_ACTION_FILE_BIT | DEBUG_ACTION_STDOUT_BIT | DEBUG_ACTION_OUTPUT_BIT)) {
+        char log[kLogMessageSize];
+        snprintf(log, kLogMessageSize, "%s", GetLogPrefix(report));
+        std::size_t len = std::strlen(log);
+
+        vsnprintf(log + len, kLogMessageSize - len, message, list);
+
+        if (layer_settings->log.async_writer != nullptr) {
+            layer_settings->log.async_writer->Push(report, log);
+        } else {
+            WriteLogMessage(layer_settings, report, log);
+        }
     }
-#endif  //_WIN32
+
+    va_end(list);
 
     if (layer_settings->log.debug_actions & DEBUG_ACTION_BREAKPOINT_BIT) {
+        // The message must be visible when the debugger stops
+        if (layer_settings->log.async_writer != nullptr) {
+            layer_settings->log.async_writer->Flush();
+        }
+        if (layer_settings->log.binary_writer != nullptr) {
+            layer_settings->log.binary_writer->Flush();
+        }
 #ifdef WIN32
         DebugBreak();
 #else
@@ -162,12 +660,19 @@ void LogFlush(ProfileLayerSettings *layer_settings) {
     assert(layer_settings);
 #endif
 
+    if (layer_settings->log.async_writer != nullptr) {
+        layer_settings->log.async_writer->Flush();
+    }
+
     if (layer_settings->log.debug_actions & DEBUG_ACTION_STDOUT_BIT) {
         std::fflush(stdout);
     }
     if (layer_settings->log.debug_actions & DEBUG_ACTION_FILE_BIT) {
         std::fflush(layer_settings->log.profiles_log_file);
     }
+    if (layer_settings->log.binary_writer != nullptr) {
+        layer_settings->log.binary_writer->Flush();
+    }
 }
 
 static std::vector<std::string> Split(const std::string &value, const std::string &delimiter) {
@@ -207,6 +712,7 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
                                               kLayerSettingsProfileDirs,
                                               kLayerSettingsProfileName,
                                               kLayerSettingsProfileValidation,
+                                              kLayerSettingsProfileCache,
                                               kLayerSettingsEmulatePortability,
                                               kLayerSettings_constantAlphaColorBlendFactors,
                                               kLayerSettings_events,
@@ -228,10 +734,13 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
                                               kLayerSettingsDebugActions,
                                               kLayerSettingsDebugFilename,
                                               kLayerSettingsDebugFileClear,
+                                              kLayerSettingsDebugBinaryFilename,
                                               kLayerSettingsDebugFailOnError,
+                                              kLayerSettingsDebugAsync,
                                               kLayerSettingsDebugReports,
                                               kLayerSettingsExcludeDeviceExtensions,
                                               kLayerSettingsExcludeFormats,
+                                              kLayerSettingsImageFormatCacheSize,
                                               kLayerSettingsDefaultFeatureValues,
                                               kLayerSettingsUnknownFeatureValues};
         uint32_t setting_name_count = static_cast<uint32_t>(std::size(setting_names));
@@ -277,6 +786,10 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
             vkuGetLayerSettingValue(layerSettingSet, kLayerSettingsProfileValidation, layer_settings->simulate.profile_validation);
         }
 
+        if (vkuHasLayerSetting(layerSettingSet, kLayerSettingsProfileCache)) {
+            vkuGetLayerSettingValue(layerSettingSet, kLayerSettingsProfileCache, layer_settings->simulate.profile_cache);
+        }
+
         if (vkuHasLayerSetting(layerSettingSet, kLayerSettingsSimulateCapabilities)) {
             std::vector<std::string> values;
             vkuGetLayerSettingValues(layerSettingSet, kLayerSettingsSimulateCapabilities, values);
@@ -308,6 +821,10 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
         vkuGetLayerSettingValues(layerSettingSet, kLayerSettingsExcludeFormats, layer_settings->simulate.exclude_formats);
     }
 
+    if (vkuHasLayerSetting(layerSettingSet, kLayerSettingsImageFormatCacheSize)) {
+        vkuGetLayerSettingValue(layerSettingSet, kLayerSettingsImageFormatCacheSize, layer_settings->simulate.image_format_cache_size);
+    }
+
     if (vkuHasLayerSetting(layerSettingSet, kLayerSettingsEmulatePortability)) {
         vkuGetLayerSettingValue(layerSettingSet, kLayerSettingsEmulatePortability, layer_settings->simulate.emulate_portability);
 
@@ -393,6 +910,10 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
         vkuGetLayerSettingValue(layerSettingSet, kLayerSettingsDebugFailOnError, layer_settings->log.debug_fail_on_error);
     }
 
+    if (vkuHasLayerSetting(layerSettingSet, kLayerSettingsDebugAsync)) {
+        vkuGetLayerSettingValue(layerSettingSet, kLayerSettingsDebugAsync, layer_settings->log.debug_async);
+    }
+
     if (vkuHasLayerSetting(layerSettingSet, kLayerSettingsDebugActions)) {
         std::vector<std::string> values;
         vkuGetLayerSettingValues(layerSettingSet, kLayerSettingsDebugActions, values);
@@ -410,6 +931,10 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
         vkuGetLayerSettingValue(layerSettingSet, kLayerSettingsDebugFileClear, layer_settings->log.debug_file_discard);
     }
 
+    if (vkuHasLayerSetting(layerSettingSet, kLayerSettingsDebugBinaryFilename)) {
+        vkuGetLayerSettingValue(layerSettingSet, kLayerSettingsDebugBinaryFilename, layer_settings->log.debug_binary_filename);
+    }
+
     if (vkuHasLayerSetting(layerSettingSet, kLayerSettingsDebugReports)) {
         std::vector<std::string> values;
         vkuGetLayerSettingValues(layerSettingSet, kLayerSettingsDebugReports, values);
@@ -436,6 +961,38 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
                    layer_settings->log.debug_filename.c_str());
     }
 
+    if (layer_settings->log.debug_actions & DEBUG_ACTION_BINARY_FILE_BIT && layer_settings->log.binary_writer == nullptr) {
+        BinaryLogWriter *binary_writer = new BinaryLogWriter;
+        if (binary_writer->Open(layer_settings->log.debug_binary_filename, layer_settings->log.debug_file_discard)) {
+            layer_settings->log.binary_writer = binary_writer;
+            LogMessage(layer_settings, DEBUG_REPORT_DEBUG_BIT, "Binary log file %s opened\n",
+                       layer_settings->log.debug_binary_filename.c_str());
+        } else {
+            delete binary_writer;
+            layer_settings->log.debug_actions &= ~DEBUG_ACTION_BINARY_FILE_BIT;
+            layer_settings->log.debug_actions |= DEBUG_ACTION_STDOUT_BIT;
+            LogMessage(layer_settings, DEBUG_REPORT_ERROR_BIT,
+                       "Could not open %s, binary log to file is being overridden by log to stdout.\n",
+                       layer_settings->log.debug_binary_filename.c_str());
+        }
+    }
+
+    if (layer_settings->log.debug_async && layer_settings->log.async_writer == nullptr) {
+        AsyncLogWriter *async_writer = new AsyncLogWriter(layer_settings);
+        if (async_writer->Start()) {
+            layer_settings->log.async_writer = async_writer;
+        } else {
+            delete async_writer;
+            LogMessage(layer_settings, DEBUG_REPORT_WARNING_BIT, "Could not start the log writer thread, messages are written synchronously.\n");
+        }
+    }
+
+    vkuDestroyLayerSettingSet(layerSettingSet, pAllocator);
+
+    if (!IsLogEnabled(layer_settings, DEBUG_REPORT_NOTIFICATION_BIT)) {
+        return;
+    }
+
     const std::string profile_dirs = GetString(layer_settings->simulate.profile_dirs);
     const std::string simulation_capabilities_log = GetSimulateCapabilitiesLog(layer_settings->simulate.capabilities);
     const std::string default_feature_values = GetDefaultFeatureValuesString(layer_settings->simulate.default_feature_values);
@@ -450,6 +1007,7 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
     settings_log += format("\t%s: %s\n", kLayerSettingsProfileName, layer_settings->simulate.profile_name.c_str());
     settings_log +=
         format("\t%s: %s\n", kLayerSettingsProfileValidation, layer_settings->simulate.profile_validation ? "true" : "false");
+    settings_log += format("\t%s: %s\n", kLayerSettingsProfileCache, layer_settings->simulate.profile_cache.c_str());
     settings_log += format("\t%s: %s\n", kLayerSettingsSimulateCapabilities, simulation_capabilities_log.c_str());
     settings_log += format("\t%s: %s\n", kLayerSettingsDefaultFeatureValues, default_feature_values.c_str());
     settings_log += format("\t%s: %s\n", kLayerSettingsUnknownFeatureValues, unknown_feature_values.c_str());
@@ -490,14 +1048,16 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
     settings_log += format("\t%s: %s\n", kLayerSettingsDebugActions, debug_actions_log.c_str());
     settings_log += format("\t%s: %s\n", kLayerSettingsDebugFilename, layer_settings->log.debug_filename.c_str());
     settings_log += format("\t%s: %s\n", kLayerSettingsDebugFileClear, layer_settings->log.debug_file_discard ? "true" : "false");
+    settings_log += format("\t%s: %s\n", kLayerSettingsDebugBinaryFilename, layer_settings->log.debug_binary_filename.c_str());
     settings_log +=
         format("\t%s: %s\n", kLayerSettingsDebugFailOnError, layer_settings->log.debug_fail_on_error ? "true" : "false");
+    settings_log += format("\t%s: %s\n", kLayerSettingsDebugAsync, layer_settings->log.debug_async ? "true" : "false");
     settings_log += format("\t%s: %s\n", kLayerSettingsDebugReports, debug_reports_log.c_str());
     settings_log += format("\t%s: %s\n", kLayerSettingsExcludeDeviceExtensions,
                            GetString(layer_settings->simulate.exclude_device_extensions).c_str());
     settings_log += format("\t%s: %s\n", kLayerSettingsExcludeFormats, GetString(layer_settings->simulate.exclude_formats).c_str());
+    settings_log += format("\t%s: %d\n", kLayerSettingsImageFormatCacheSize,
+                           static_cast<int>(layer_settings->simulate.image_format_cache_size));
 
     LogMessage(layer_settings, DEBUG_REPORT_NOTIFICATION_BIT, "Profile Layers Settings: {\n%s}\n", settings_log.c_str());
-
-    vkuDestroyLayerSettingSet(layerSettingSet, pAllocator);
 }
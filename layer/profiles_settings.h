@@ -43,6 +43,7 @@ enum DebugActionBits {
     DEBUG_ACTION_STDOUT_BIT = (1 << 1),
     DEBUG_ACTION_OUTPUT_BIT = (1 << 2),
     DEBUG_ACTION_BREAKPOINT_BIT = (1 << 3),
+    DEBUG_ACTION_BINARY_FILE_BIT = (1 << 4),
     DEBUG_ACTION_MAX_ENUM = 0x7FFFFFFF
 };
 typedef int DebugActionFlags;
@@ -59,6 +60,8 @@ static DebugActionFlags GetDebugActionFlags(const std::vector<std::string> &valu
             result |= DEBUG_ACTION_OUTPUT_BIT;
         } else if (values[i] == "DEBUG_ACTION_BREAKPOINT_BIT") {
             result |= DEBUG_ACTION_BREAKPOINT_BIT;
+        } else if (values[i] == "DEBUG_ACTION_BINARY_FILE_BIT") {
+            result |= DEBUG_ACTION_BINARY_FILE_BIT;
         } else if (values[i] == "DEBUG_ACTION_MAX_ENUM") {
             result = DEBUG_ACTION_MAX_ENUM;
         }
@@ -72,7 +75,8 @@ static std::vector<std::string> GetDebugActionStrings(DebugActionFlags flags) {
         "DEBUG_ACTION_FILE_BIT",
         "DEBUG_ACTION_STDOUT_BIT",
         "DEBUG_ACTION_OUTPUT_BIT",
-        "DEBUG_ACTION_BREAKPOINT_BIT"
+        "DEBUG_ACTION_BREAKPOINT_BIT",
+        "DEBUG_ACTION_BINARY_FILE_BIT"
     };
 
     std::vector<std::string> result;
@@ -167,13 +171,14 @@ static std::string GetUnknownFeatureValuesString(UnknownFeatureValues value) {
     return "UNKNOWN_FEATURE_VALUES_UNCHANGED";
 }
 
+class AsyncLogWriter;
+class BinaryLogWriter;
+
 struct ProfileLayerSettings {
-    ~ProfileLayerSettings() {
-        if (log.profiles_log_file != nullptr) {
-            fclose(log.profiles_log_file);
-            log.profiles_log_file = nullptr;
-        }
-    }
+    ProfileLayerSettings() = default;
+    ProfileLayerSettings(const ProfileLayerSettings &) = delete;
+    ProfileLayerSettings &operator=(const ProfileLayerSettings &) = delete;
+    ~ProfileLayerSettings();
 
     struct Simulate {
         bool profile_emulation{true};
@@ -181,11 +186,13 @@ struct ProfileLayerSettings {
         std::vector<std::string> profile_dirs;
         std::string profile_name{"${VP_DEFAULT}"};
         bool profile_validation{false};
+        std::string profile_cache{};
         SimulateCapabilityFlags capabilities{SIMULATE_API_VERSION_BIT | SIMULATE_FEATURES_BIT | SIMULATE_PROPERTIES_BIT};
         DefaultFeatureValues default_feature_values{DEFAULT_FEATURE_VALUES_DEVICE};
         UnknownFeatureValues unknown_feature_values{UNKNOWN_FEATURE_VALUES_UNCHANGED};
         std::vector<std::string> exclude_device_extensions;
         std::vector<std::string> exclude_formats;
+        uint32_t image_format_cache_size{0};
         bool emulate_portability{true};
     } simulate;
 
@@ -212,9 +219,13 @@ struct ProfileLayerSettings {
         DebugActionFlags debug_actions{DEBUG_ACTION_STDOUT_BIT};
         std::string debug_filename{"profiles_layer_log.txt"};
         bool debug_file_discard{true};
+        std::string debug_binary_filename{"profiles_layer_log.bin"};
         DebugReportFlags debug_reports{DEBUG_REPORT_WARNING_BIT | DEBUG_REPORT_ERROR_BIT};
         bool debug_fail_on_error{false};
+        bool debug_async{false};
         FILE *profiles_log_file{nullptr};
+        AsyncLogWriter *async_writer{nullptr};  // Writer thread of the messages when debug_async is enabled
+        BinaryLogWriter *binary_writer{nullptr};  // Records of the messages when DEBUG_ACTION_BINARY_FILE_BIT is enabled
     } log;
 };
 
@@ -222,13 +233,16 @@ void InitProfilesLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const Vk
                                ProfileLayerSettings *layer_settings);
 
 void WarnMissingFormatFeatures(ProfileLayerSettings* layer_settings, const char *device_name, const std::string &format_name,
-                               const std::string &features,
+                               const char *features,
                                VkFormatFeatureFlags profile_features, VkFormatFeatureFlags device_features);
 
 void WarnMissingFormatFeatures2(ProfileLayerSettings *layer_settings, const char *device_name, const std::string &format_name,
-                                const std::string &features,
+                                const char *features,
                                 VkFormatFeatureFlags2 profile_features, VkFormatFeatureFlags2 device_features);
 
+// Whether a message of this report type reaches an output, so that call sites skip building its arguments otherwise
+bool IsLogEnabled(const ProfileLayerSettings *layer_settings, DebugReportBits report);
+
 void LogMessage(ProfileLayerSettings *layer_settings, DebugReportBits report, const char *message, ...);
 
 void LogFlush(ProfileLayerSettings *layer_settings);
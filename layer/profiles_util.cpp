@@ -157,3 +157,69 @@ bool GlobalPriorityMatch(const VkQueueFamilyGlobalPriorityPropertiesKHR &device,
     }
     return match;
 }
+
+// Whether each profile queue family not assigned yet can be matched with its own device queue family, among the device queue
+// families from first_device, using augmenting paths
+static bool CanMatchQueueFamilies(const std::vector<std::vector<bool>> &compatible, std::size_t first_device,
+                                  const std::vector<bool> &assigned_profile) {
+    const std::size_t device_count = compatible.size();
+    const std::size_t profile_count = assigned_profile.size();
+
+    // Profile queue family matched with each device queue family
+    std::vector<std::size_t> device_match(device_count, SIZE_MAX);
+    std::vector<bool> visited(device_count);
+
+    const std::function<bool(std::size_t)> augment = [&](std::size_t profile) -> bool {
+        for (std::size_t device = first_device; device < device_count; ++device) {
+            if (!compatible[device][profile] || visited[device]) {
+                continue;
+            }
+            visited[device] = true;
+            if (device_match[device] == SIZE_MAX || augment(device_match[device])) {
+                device_match[device] = profile;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (std::size_t profile = 0; profile < profile_count; ++profile) {
+        if (assigned_profile[profile]) {
+            continue;
+        }
+        std::fill(visited.begin(), visited.end(), false);
+        if (!augment(profile)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MatchQueueFamilies(const std::vector<std::vector<bool>> &compatible, std::size_t profile_count,
+                        std::vector<std::size_t> *assignment) {
+    assert(assignment);
+    const std::size_t device_count = compatible.size();
+
+    std::vector<bool> assigned_profile(profile_count, false);
+    if (!CanMatchQueueFamilies(compatible, 0, assigned_profile)) {
+        return false;
+    }
+
+    // Give each device queue family, in order, the first profile queue family that still lets the remaining ones be matched,
+    // which is the ordering of the first matching permutation of the profile queue families
+    assignment->assign(device_count, SIZE_MAX);
+    for (std::size_t device = 0; device < device_count; ++device) {
+        for (std::size_t profile = 0; profile < profile_count; ++profile) {
+            if (assigned_profile[profile] || !compatible[device][profile]) {
+                continue;
+            }
+            assigned_profile[profile] = true;
+            if (CanMatchQueueFamilies(compatible, device + 1, assigned_profile)) {
+                (*assignment)[device] = profile;
+                break;
+            }
+            assigned_profile[profile] = false;
+        }
+    }
+    return true;
+}
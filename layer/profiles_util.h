@@ -31,8 +31,10 @@
 #include <unordered_map>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <fstream>
 #include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <optional>
 #include <algorithm>
@@ -216,6 +218,12 @@ bool QueueFamilyMatch(const VkQueueFamilyProperties &device, const VkQueueFamily
 bool GlobalPriorityMatch(const VkQueueFamilyGlobalPriorityPropertiesKHR &device,
                          const VkQueueFamilyGlobalPriorityPropertiesKHR &profile);
 
+// Matches each profile queue family with its own compatible device queue family, compatible being indexed by device then
+// profile queue family. Each device queue family gets, in order, the first profile queue family that still lets the remaining
+// ones be matched, or SIZE_MAX. Returns false when the profile queue families can't all be matched simultaneously.
+bool MatchQueueFamilies(const std::vector<std::vector<bool>> &compatible, std::size_t profile_count,
+                        std::vector<std::size_t> *assignment);
+
 inline bool HasFlags(VkFlags deviceFlags, VkFlags profileFlags) {
     return (deviceFlags & profileFlags) == profileFlags;
 }
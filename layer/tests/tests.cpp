@@ -785,3 +785,79 @@ TEST_F(LayerTests, TestQueueFamilyPropertiesPartial) {
         }
     }
 }
+
+TEST_F(LayerTests, TestQueueFamilyPropertiesReordered) {
+    TEST_DESCRIPTION("Test profile queue families that can only be matched by moving the first one to a later device queue family");
+
+    VkResult err = VK_SUCCESS;
+
+    profiles_test::VulkanInstanceBuilder inst_builder;
+
+    std::vector<VkQueueFamilyProperties> device_qf_props;
+    {
+        err = inst_builder.init();
+        ASSERT_EQ(err, VK_SUCCESS);
+
+        VkPhysicalDevice gpu;
+        err = inst_builder.getPhysicalDevice(profiles_test::MODE_NATIVE, &gpu);
+        ASSERT_EQ(err, VK_SUCCESS);
+
+        uint32_t count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, nullptr);
+        device_qf_props.resize(count);
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, device_qf_props.data());
+
+        inst_builder.reset();
+    }
+
+    // The profile transfer queue family is first, so it is first matched with the device queue family 0, which must then be
+    // given to the profile graphics queue family instead when it is the only graphics queue family of the device
+    std::size_t transfer_index = 0;
+    for (std::size_t i = 1; i < device_qf_props.size(); ++i) {
+        if (device_qf_props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            transfer_index = 0;
+            break;
+        }
+        if (transfer_index == 0 && (device_qf_props[i].queueFlags & VK_QUEUE_TRANSFER_BIT)) {
+            transfer_index = i;
+        }
+    }
+    const VkQueueFlags graphics_transfer = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT;
+    if (transfer_index == 0 || (device_qf_props[0].queueFlags & graphics_transfer) != graphics_transfer) {
+        printf("Device queue families don't need to be reordered, skipping test.\n");
+        return;
+    }
+
+    const char* profile_file_data = JSON_TEST_FILES_PATH "VP_LUNARG_test_vkqueuefamilyproperties.json";
+    const char* profile_name_data = "VP_LUNARG_test_vkqueuefamilyproperties3";
+    const std::vector<const char*> simulate_capabilities = {"SIMULATE_QUEUE_FAMILY_PROPERTIES_BIT"};
+    VkBool32 emulate_portability_data = VK_TRUE;
+    VkBool32 debug_fail_on_error = VK_TRUE;
+
+    std::vector<VkLayerSettingEXT> settings = {
+        {kLayerName, kLayerSettingsProfileFile, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &profile_file_data},
+        {kLayerName, kLayerSettingsProfileName, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &profile_name_data},
+        {kLayerName, kLayerSettingsSimulateCapabilities, VK_LAYER_SETTING_TYPE_STRING_EXT, static_cast<uint32_t>(simulate_capabilities.size()), &simulate_capabilities[0]},
+        {kLayerName, kLayerSettingsEmulatePortability, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &emulate_portability_data},
+        {kLayerName, kLayerSettingsDebugFailOnError, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &debug_fail_on_error}
+    };
+
+    err = inst_builder.init(settings);
+    ASSERT_EQ(err, VK_SUCCESS);
+
+    VkPhysicalDevice gpu;
+    err = inst_builder.getPhysicalDevice(profiles_test::MODE_PROFILE, &gpu);
+    ASSERT_EQ(err, VK_SUCCESS);
+
+    uint32_t count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, nullptr);
+    std::vector<VkQueueFamilyProperties> qf_props(count);
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, qf_props.data());
+
+    ASSERT_EQ(count, static_cast<uint32_t>(transfer_index + 1));
+    EXPECT_EQ(qf_props[0].queueFlags, VK_QUEUE_GRAPHICS_BIT);
+    EXPECT_EQ(qf_props[transfer_index].queueFlags, VK_QUEUE_TRANSFER_BIT);
+    for (std::size_t i = 1; i < transfer_index; ++i) {
+        EXPECT_EQ(qf_props[i].queueFlags, device_qf_props[i].queueFlags);
+    }
+}
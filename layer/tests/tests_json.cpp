@@ -0,0 +1,367 @@
+/*
+ * Copyright (C) 2026-2026 Valve Corporation
+ * Copyright (C) 2026-2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include <gtest/gtest.h>
+#include "../profiles_json.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace fs = std::filesystem;
+
+class TestsJson : public testing::Test {
+   protected:
+    void SetUp() override {
+        std::random_device random;
+        directory_ = fs::temp_directory_path() / ("vk_profiles_tests_json_" + std::to_string(random()));
+        fs::create_directories(directory_);
+    }
+
+    void TearDown() override {
+        std::error_code error;
+        fs::remove_all(directory_, error);
+    }
+
+    std::string Path(const char *filename) const { return (directory_ / filename).generic_string(); }
+
+    std::string WriteFile(const char *filename, const std::string &content) const {
+        const std::string path = Path(filename);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << content;
+        return path;
+    }
+
+    static std::string ReadFile(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    // Rewrite a file with a different size so that its stamp changes regardless of the file system time resolution
+    void ModifyFile(const std::string &path, const std::string &content) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << content;
+        file.close();
+        fs::last_write_time(path, fs::last_write_time(path) + std::chrono::seconds(2));
+    }
+
+    static Json::Value MakeProfileRoot() {
+        Json::Value root(Json::objectValue);
+        root["$schema"] = "https://schema.khronos.org/vulkan/profiles-0.8-latest.json#";
+        root["int"] = Json::Value(static_cast<Json::Int64>(-42));
+        root["uint"] = Json::Value(static_cast<Json::UInt64>(0xFFFFFFFFFFull));
+        root["real"] = 0.5;
+        root["true"] = true;
+        root["false"] = false;
+        root["null"] = Json::nullValue;
+        root["array"].append("string");
+        root["array"].append(Json::Value(Json::arrayValue));
+        root["object"]["nested"]["member"] = 1;
+        return root;
+    }
+
+    fs::path directory_;
+};
+
+TEST_F(TestsJson, ProfileCacheRoundTrip) {
+    const std::string cache_path = Path("cache.bin");
+    const std::string schema_path = WriteFile("schema.json", "{}");
+    const std::string profile_path = WriteFile("profile.json", "{ \"profile\": true }");
+    const std::string other_path = WriteFile("other.json", "{ \"other\": true }");
+    const Json::Value root = MakeProfileRoot();
+
+    {
+        JsonProfileCache cache;
+        EXPECT_FALSE(cache.Load(cache_path, schema_path));
+        cache.Store(profile_path, JsonProfileCache::ENTRY_PROFILE, root);
+        cache.Store(other_path, JsonProfileCache::ENTRY_NOT_A_PROFILE, Json::nullValue);
+        EXPECT_TRUE(cache.IsDirty());
+        EXPECT_TRUE(cache.Save(cache_path));
+        EXPECT_FALSE(cache.IsDirty());
+    }
+
+    // The temporary file of the save was renamed to the cache file
+    std::size_t file_count = 0;
+    for (const auto &entry : fs::directory_iterator(directory_)) {
+        EXPECT_EQ(std::string::npos, entry.path().filename().generic_string().find(".tmp"));
+        ++file_count;
+    }
+    EXPECT_EQ(4u, file_count);
+
+    JsonProfileCache cache;
+    EXPECT_TRUE(cache.Load(cache_path, schema_path));
+    EXPECT_FALSE(cache.IsDirty());
+
+    JsonProfileCache::EntryType type = JsonProfileCache::ENTRY_NOT_A_PROFILE;
+    Json::Value found;
+    EXPECT_TRUE(cache.Find(profile_path, &type, &found));
+    EXPECT_EQ(JsonProfileCache::ENTRY_PROFILE, type);
+    EXPECT_EQ(root, found);
+    EXPECT_EQ(Json::intValue, found["int"].type());
+    EXPECT_EQ(Json::uintValue, found["uint"].type());
+
+    EXPECT_TRUE(cache.Find(other_path, &type, &found));
+    EXPECT_EQ(JsonProfileCache::ENTRY_NOT_A_PROFILE, type);
+    EXPECT_EQ(Json::nullValue, found.type());
+
+    EXPECT_FALSE(cache.Find(Path("missing.json"), &type, &found));
+}
+
+TEST_F(TestsJson, ProfileCacheModifiedFile) {
+    const std::string cache_path = Path("cache.bin");
+    const std::string schema_path = WriteFile("schema.json", "{}");
+    const std::string profile_path = WriteFile("profile.json", "{ \"profile\": true }");
+
+    JsonProfileCache cache;
+    cache.Load(cache_path, schema_path);
+    cache.Store(profile_path, JsonProfileCache::ENTRY_PROFILE, MakeProfileRoot());
+    EXPECT_TRUE(cache.Save(cache_path));
+
+    ModifyFile(profile_path, "{ \"profile\": false }");
+
+    JsonProfileCache reloaded;
+    EXPECT_TRUE(reloaded.Load(cache_path, schema_path));
+
+    JsonProfileCache::EntryType type = JsonProfileCache::ENTRY_NOT_A_PROFILE;
+    Json::Value found;
+    EXPECT_FALSE(reloaded.Find(profile_path, &type, &found));
+}
+
+TEST_F(TestsJson, ProfileCacheValidatedWithSchema) {
+    const std::string cache_path = Path("cache.bin");
+    const std::string schema_path = WriteFile("schema.json", "{}");
+    const std::string profile_path = WriteFile("profile.json", "{ \"profile\": true }");
+
+    {
+        JsonProfileCache cache;
+        cache.Load(cache_path, schema_path);
+        cache.Store(profile_path, JsonProfileCache::ENTRY_VALIDATED_PROFILE, MakeProfileRoot());
+        EXPECT_TRUE(cache.Save(cache_path));
+    }
+
+    JsonProfileCache::EntryType type = JsonProfileCache::ENTRY_NOT_A_PROFILE;
+    Json::Value found;
+
+    {
+        JsonProfileCache cache;
+        EXPECT_TRUE(cache.Load(cache_path, schema_path));
+        EXPECT_TRUE(cache.Find(profile_path, &type, &found));
+        EXPECT_EQ(JsonProfileCache::ENTRY_VALIDATED_PROFILE, type);
+    }
+
+    // Without a schema, the validation result can't be trusted
+    {
+        JsonProfileCache cache;
+        EXPECT_TRUE(cache.Load(cache_path, std::string()));
+        EXPECT_TRUE(cache.IsDirty());
+        EXPECT_TRUE(cache.Find(profile_path, &type, &found));
+        EXPECT_EQ(JsonProfileCache::ENTRY_PROFILE, type);
+    }
+
+    // Another schema file
+    {
+        const std::string other_schema_path = WriteFile("other_schema.json", "{}");
+
+        JsonProfileCache cache;
+        EXPECT_TRUE(cache.Load(cache_path, other_schema_path));
+        EXPECT_TRUE(cache.Find(profile_path, &type, &found));
+        EXPECT_EQ(JsonProfileCache::ENTRY_PROFILE, type);
+    }
+
+    // The schema file was modified since the profile was validated
+    {
+        ModifyFile(schema_path, "{ \"modified\": true }");
+
+        JsonProfileCache cache;
+        EXPECT_TRUE(cache.Load(cache_path, schema_path));
+        EXPECT_TRUE(cache.Find(profile_path, &type, &found));
+        EXPECT_EQ(JsonProfileCache::ENTRY_PROFILE, type);
+
+        // Validated again with the new schema
+        cache.Store(profile_path, JsonProfileCache::ENTRY_VALIDATED_PROFILE, found);
+        EXPECT_TRUE(cache.Save(cache_path));
+    }
+
+    {
+        JsonProfileCache cache;
+        EXPECT_TRUE(cache.Load(cache_path, schema_path));
+        EXPECT_TRUE(cache.Find(profile_path, &type, &found));
+        EXPECT_EQ(JsonProfileCache::ENTRY_VALIDATED_PROFILE, type);
+    }
+}
+
+TEST_F(TestsJson, ProfileCacheInvalidFile) {
+    const std::string cache_path = Path("cache.bin");
+    const std::string schema_path = WriteFile("schema.json", "{}");
+    const std::string profile_path = WriteFile("profile.json", "{ \"profile\": true }");
+
+    {
+        JsonProfileCache cache;
+        cache.Load(cache_path, schema_path);
+        cache.Store(profile_path, JsonProfileCache::ENTRY_PROFILE, MakeProfileRoot());
+        EXPECT_TRUE(cache.Save(cache_path));
+    }
+    const std::string content = ReadFile(cache_path);
+    ASSERT_GT(content.size(), 16u);
+
+    JsonProfileCache::EntryType type = JsonProfileCache::ENTRY_NOT_A_PROFILE;
+    Json::Value found;
+
+    // Every truncation of the cache file is rejected
+    for (std::size_t size = 0; size < content.size(); ++size) {
+        WriteFile("cache.bin", content.substr(0, size));
+
+        JsonProfileCache cache;
+        EXPECT_FALSE(cache.Load(cache_path, schema_path)) << "size: " << size;
+        EXPECT_TRUE(cache.IsDirty());
+        EXPECT_FALSE(cache.Find(profile_path, &type, &found));
+    }
+
+    // Trailing data
+    {
+        WriteFile("cache.bin", content + "x");
+
+        JsonProfileCache cache;
+        EXPECT_FALSE(cache.Load(cache_path, schema_path));
+        EXPECT_FALSE(cache.Find(profile_path, &type, &found));
+    }
+
+    // Magic mismatch
+    {
+        std::string modified = content;
+        modified[0] = 'X';
+        WriteFile("cache.bin", modified);
+
+        JsonProfileCache cache;
+        EXPECT_FALSE(cache.Load(cache_path, schema_path));
+        EXPECT_FALSE(cache.Find(profile_path, &type, &found));
+    }
+
+    // Version mismatch
+    {
+        std::string modified = content;
+        modified[4] = static_cast<char>(modified[4] + 1);
+        WriteFile("cache.bin", modified);
+
+        JsonProfileCache cache;
+        EXPECT_FALSE(cache.Load(cache_path, schema_path));
+        EXPECT_FALSE(cache.Find(profile_path, &type, &found));
+    }
+
+    // The cache is rebuilt after a failed load
+    {
+        JsonProfileCache cache;
+        EXPECT_FALSE(cache.Load(cache_path, schema_path));
+        cache.Store(profile_path, JsonProfileCache::ENTRY_PROFILE, MakeProfileRoot());
+        EXPECT_TRUE(cache.Save(cache_path));
+
+        JsonProfileCache reloaded;
+        EXPECT_TRUE(reloaded.Load(cache_path, schema_path));
+        EXPECT_TRUE(reloaded.Find(profile_path, &type, &found));
+        EXPECT_EQ(MakeProfileRoot(), found);
+    }
+}
+
+TEST(TestsJsonProbe, SchemaFirstMember) {
+    const std::string json =
+        "\xEF\xBB\xBF{ \"$schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\", \"profiles\": {} }";
+    EXPECT_EQ(JSON_PROBE_PROFILES, ProbeProfilesSchema(json.data(), json.size()));
+}
+
+TEST(TestsJsonProbe, SchemaAfterOtherMembers) {
+    const std::string json =
+        "{\n"
+        "    \"string\": \"{ [ } ]\",\n"
+        "    \"number\": -1.5e3,\n"
+        "    \"true\": true,\n"
+        "    \"null\": null,\n"
+        "    \"array\": [ 1, \"]\", [ {} ] ],\n"
+        "    \"object\": { \"nested\": { \"$schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\" } },\n"
+        "    \"$schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\"\n"
+        "}\n";
+    EXPECT_EQ(JSON_PROBE_PROFILES, ProbeProfilesSchema(json.data(), json.size()));
+}
+
+TEST(TestsJsonProbe, SchemaPastProbeSize) {
+    // The layer first probes the 4KB at the beginning of the file and then the whole file
+    const std::size_t probe_size = 4096;
+
+    const std::string json = "{ \"capabilities\": { \"data\": \"" + std::string(probe_size, 'x') +
+                             "\" }, \"$schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\" }";
+    EXPECT_EQ(JSON_PROBE_INCOMPLETE, ProbeProfilesSchema(json.data(), probe_size));
+    EXPECT_EQ(JSON_PROBE_PROFILES, ProbeProfilesSchema(json.data(), json.size()));
+
+    const std::string other = "{ \"capabilities\": { \"data\": \"" + std::string(probe_size, 'x') + "\" }, \"name\": 1 }";
+    EXPECT_EQ(JSON_PROBE_INCOMPLETE, ProbeProfilesSchema(other.data(), probe_size));
+    EXPECT_EQ(JSON_PROBE_NOT_PROFILES, ProbeProfilesSchema(other.data(), other.size()));
+}
+
+TEST(TestsJsonProbe, EscapedStrings) {
+    // The escaped quotes and backslashes of the skipped values don't end the strings
+    const std::string values =
+        "{ \"quote\": \"\\\"}\", \"backslash\": \"\\\\\", \"nested\": [ \"\\\\\\\"]\" ], "
+        "\"$schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\" }";
+    EXPECT_EQ(JSON_PROBE_PROFILES, ProbeProfilesSchema(values.data(), values.size()));
+
+    // An escaped key or $schema value requires the full parse to be decoded
+    const std::string key = "{ \"\\u0024schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\" }";
+    EXPECT_EQ(JSON_PROBE_UNKNOWN, ProbeProfilesSchema(key.data(), key.size()));
+
+    const std::string schema = "{ \"$schema\": \"https:\\/\\/schema.khronos.org\\/vulkan\\/profiles-0.8-latest.json#\" }";
+    EXPECT_EQ(JSON_PROBE_UNKNOWN, ProbeProfilesSchema(schema.data(), schema.size()));
+}
+
+TEST(TestsJsonProbe, NotAProfile) {
+    const std::string empty = "{}";
+    EXPECT_EQ(JSON_PROBE_NOT_PROFILES, ProbeProfilesSchema(empty.data(), empty.size()));
+
+    const std::string no_schema =
+        "{ \"name\": \"VP_LUNARG_test\", \"profiles\": { \"$schema\": \"https://schema.khronos.org/vulkan/profiles\" } }";
+    EXPECT_EQ(JSON_PROBE_NOT_PROFILES, ProbeProfilesSchema(no_schema.data(), no_schema.size()));
+
+    const std::string other_schema = "{ \"$schema\": \"http://json-schema.org/draft-07/schema#\", \"type\": \"object\" }";
+    EXPECT_EQ(JSON_PROBE_NOT_PROFILES, ProbeProfilesSchema(other_schema.data(), other_schema.size()));
+
+    // Not an object or with a syntax the probe doesn't handle, the full parse reports the error
+    const std::string array = "[ { \"$schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\" } ]";
+    EXPECT_EQ(JSON_PROBE_UNKNOWN, ProbeProfilesSchema(array.data(), array.size()));
+
+    const std::string comment =
+        "{ \"object\": { /* comment */ }, \"$schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\" }";
+    EXPECT_EQ(JSON_PROBE_UNKNOWN, ProbeProfilesSchema(comment.data(), comment.size()));
+
+    const std::string missing_colon = "{ \"$schema\" \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\" }";
+    EXPECT_EQ(JSON_PROBE_UNKNOWN, ProbeProfilesSchema(missing_colon.data(), missing_colon.size()));
+}
+
+TEST(TestsJsonProbe, Truncated) {
+    const std::string json =
+        "{ \"label\": \"a \\\"label\\\"\", \"version\": 12, \"flag\": false, \"array\": [ 1, 2 ], "
+        "\"$schema\": \"https://schema.khronos.org/vulkan/profiles-0.8-latest.json#\" }";
+    const std::size_t schema_end = json.rfind('"') + 1;
+
+    // Every truncation before the end of the $schema value may still be a profile
+    for (std::size_t size = 0; size < schema_end; ++size) {
+        EXPECT_EQ(JSON_PROBE_INCOMPLETE, ProbeProfilesSchema(json.data(), size)) << "size: " << size;
+    }
+    for (std::size_t size = schema_end; size <= json.size(); ++size) {
+        EXPECT_EQ(JSON_PROBE_PROFILES, ProbeProfilesSchema(json.data(), size)) << "size: " << size;
+    }
+}
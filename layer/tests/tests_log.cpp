@@ -0,0 +1,491 @@
+/*
+ * Copyright (C) 2026-2026 Valve Corporation
+ * Copyright (C) 2026-2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include <gtest/gtest.h>
+#include "../profiles.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// Reader of the binary log layout written by BinaryLogWriter in profiles_settings.cpp
+struct BinaryLog {
+    enum RecordKind : uint32_t { RECORD_FORMAT = 0, RECORD_MESSAGE = 1 };
+    enum ArgumentType : uint8_t { ARGUMENT_INT = 0, ARGUMENT_UINT = 1, ARGUMENT_DOUBLE = 2, ARGUMENT_STRING = 3, ARGUMENT_POINTER = 4 };
+
+    struct Argument {
+        ArgumentType type;
+        int64_t int_value{0};
+        uint64_t uint_value{0};
+        double double_value{0.0};
+        std::string string_value;
+    };
+
+    struct Message {
+        std::string format;
+        uint32_t report{0};
+        std::vector<Argument> arguments;
+    };
+
+    bool Read(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        std::map<uint32_t, std::string> formats;
+        std::size_t offset = 0;
+        while (offset < data.size()) {
+            if (data.compare(offset, 4, "VPLB") == 0) {
+                uint32_t version = 0;
+                if (!Get(data, offset + 4, &version) || version != 1) {
+                    return false;
+                }
+                formats.clear();
+                offset += 8;
+                ++header_count;
+                continue;
+            }
+
+            uint32_t kind = 0;
+            uint32_t size = 0;
+            uint32_t id = 0;
+            if (!Get(data, offset, &kind) || !Get(data, offset + 4, &size) || offset + 8 + size > data.size() ||
+                !Get(data, offset + 8, &id)) {
+                return false;
+            }
+            const std::string record = data.substr(offset + 12, size - 4);
+            offset += 8 + size;
+
+            if (kind == RECORD_FORMAT) {
+                if (formats.count(id) != 0) {
+                    return false;
+                }
+                formats[id] = record;
+                ++format_count;
+            } else if (kind == RECORD_MESSAGE) {
+                if (formats.count(id) == 0) {
+                    return false;
+                }
+                Message message;
+                message.format = formats[id];
+                Get(record, 0, &message.report);
+                if (!ReadArguments(record.substr(12), &message.arguments)) {
+                    return false;
+                }
+                messages.push_back(message);
+            }
+        }
+        return true;
+    }
+
+    std::vector<Message> Find(const char *format) const {
+        std::vector<Message> result;
+        for (const Message &message : messages) {
+            if (message.format == format) {
+                result.push_back(message);
+            }
+        }
+        return result;
+    }
+
+    std::size_t header_count{0};
+    std::size_t format_count{0};
+    std::vector<Message> messages;
+
+   private:
+    template <typename T>
+    static bool Get(const std::string &data, std::size_t offset, T *value) {
+        if (offset + sizeof(T) > data.size()) {
+            return false;
+        }
+        std::memcpy(value, data.data() + offset, sizeof(T));
+        return true;
+    }
+
+    static bool ReadArguments(const std::string &data, std::vector<Argument> *arguments) {
+        std::size_t offset = 0;
+        while (offset < data.size()) {
+            Argument argument;
+            argument.type = static_cast<ArgumentType>(data[offset++]);
+            bool result = false;
+            switch (argument.type) {
+                case ARGUMENT_INT:
+                    result = Get(data, offset, &argument.int_value);
+                    offset += sizeof(int64_t);
+                    break;
+                case ARGUMENT_UINT:
+                case ARGUMENT_POINTER:
+                    result = Get(data, offset, &argument.uint_value);
+                    offset += sizeof(uint64_t);
+                    break;
+                case ARGUMENT_DOUBLE:
+                    result = Get(data, offset, &argument.double_value);
+                    offset += sizeof(double);
+                    break;
+                case ARGUMENT_STRING: {
+                    uint32_t length = 0;
+                    result = Get(data, offset, &length) && offset + sizeof(length) + length <= data.size();
+                    if (result) {
+                        argument.string_value = data.substr(offset + sizeof(length), length);
+                    }
+                    offset += sizeof(length) + length;
+                    break;
+                }
+                default:
+                    break;
+            }
+            if (!result) {
+                return false;
+            }
+            arguments->push_back(argument);
+        }
+        return true;
+    }
+};
+
+class TestsLog : public testing::Test {
+   protected:
+    void SetUp() override {
+        std::random_device random;
+        directory_ = fs::temp_directory_path() / ("vk_profiles_tests_log_" + std::to_string(random()));
+        fs::create_directories(directory_);
+        filename_ = (directory_ / "log.bin").generic_string();
+        text_filename_ = (directory_ / "log.txt").generic_string();
+    }
+
+    void TearDown() override {
+        std::error_code error;
+        fs::remove_all(directory_, error);
+    }
+
+    static std::unique_ptr<ProfileLayerSettings> CreateSettings(const std::vector<VkLayerSettingEXT> &settings) {
+        VkLayerSettingsCreateInfoEXT layer_settings_create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_CREATE_INFO_EXT, nullptr,
+                                                                static_cast<uint32_t>(settings.size()), settings.data()};
+
+        VkInstanceCreateInfo create_info{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+        create_info.pNext = &layer_settings_create_info;
+
+        std::unique_ptr<ProfileLayerSettings> layer_settings(new ProfileLayerSettings);
+        InitProfilesLayerSettings(&create_info, nullptr, layer_settings.get());
+        return layer_settings;
+    }
+
+    std::unique_ptr<ProfileLayerSettings> CreateSettings(bool discard) const {
+        const char *debug_actions[] = {"DEBUG_ACTION_BINARY_FILE_BIT"};
+        const char *debug_reports[] = {"DEBUG_REPORT_ERROR_BIT"};
+        const char *filename = filename_.c_str();
+        const VkBool32 file_clear = discard ? VK_TRUE : VK_FALSE;
+
+        return CreateSettings({{kLayerName, kLayerSettingsDebugActions, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, debug_actions},
+                               {kLayerName, kLayerSettingsDebugReports, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, debug_reports},
+                               {kLayerName, kLayerSettingsDebugBinaryFilename, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &filename},
+                               {kLayerName, kLayerSettingsDebugFileClear, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &file_clear}});
+    }
+
+    // Text log file written by the writer thread
+    std::unique_ptr<ProfileLayerSettings> CreateAsyncSettings() const {
+        const char *debug_actions[] = {"DEBUG_ACTION_FILE_BIT"};
+        const char *debug_reports[] = {"DEBUG_REPORT_ERROR_BIT"};
+        const char *filename = text_filename_.c_str();
+        const VkBool32 async = VK_TRUE;
+
+        return CreateSettings({{kLayerName, kLayerSettingsDebugActions, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, debug_actions},
+                               {kLayerName, kLayerSettingsDebugReports, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, debug_reports},
+                               {kLayerName, kLayerSettingsDebugFilename, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &filename},
+                               {kLayerName, kLayerSettingsDebugAsync, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &async}});
+    }
+
+    // Indices of the "Thread %d message %d" lines of the text log, per thread
+    std::vector<std::vector<int>> ReadAsyncMessages(int thread_count) const {
+        std::vector<std::vector<int>> result(thread_count);
+
+        std::ifstream file(text_filename_);
+        std::string line;
+        while (std::getline(file, line)) {
+            int thread = -1;
+            int message = -1;
+            if (std::sscanf(line.c_str(), "PROFILES ERROR: Thread %d message %d", &thread, &message) == 2 && thread >= 0 &&
+                thread < thread_count) {
+                result[thread].push_back(message);
+            }
+        }
+        return result;
+    }
+
+    static void ExpectSequence(const std::vector<int> &messages, int count) {
+        ASSERT_EQ(static_cast<std::size_t>(count), messages.size());
+        for (int i = 0; i < count; ++i) {
+            EXPECT_EQ(i, messages[i]);
+        }
+    }
+
+    fs::path directory_;
+    std::string filename_;
+    std::string text_filename_;
+};
+
+TEST_F(TestsLog, BinaryArguments) {
+    static const char *kFormat = "%d %i %u %x %lld %llu %zu %hhu %hu %ld %c %s %s %p %% %f %.*f %*d\n";
+
+    int value = 0;
+    {
+        std::unique_ptr<ProfileLayerSettings> layer_settings = CreateSettings(true);
+        ASSERT_TRUE(layer_settings->log.debug_actions & DEBUG_ACTION_BINARY_FILE_BIT);
+
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, kFormat, -1, -2, 3u, 0xFFu, -4ll, 5ull, std::size_t(6),
+                   static_cast<unsigned char>(0xFF), static_cast<unsigned short>(8), -9l, 'c', "string",
+                   static_cast<const char *>(nullptr), static_cast<void *>(&value), 0.5, 3, 0.25, 4, 10);
+
+        // Not enabled report, not written
+        LogMessage(layer_settings.get(), DEBUG_REPORT_WARNING_BIT, "Warning %d\n", 0);
+    }
+
+    BinaryLog log;
+    ASSERT_TRUE(log.Read(filename_));
+    EXPECT_EQ(1u, log.header_count);
+    EXPECT_TRUE(log.Find("Warning %d\n").empty());
+
+    const std::vector<BinaryLog::Message> messages = log.Find(kFormat);
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_EQ(static_cast<uint32_t>(DEBUG_REPORT_ERROR_BIT), messages[0].report);
+
+    const std::vector<BinaryLog::Argument> &arguments = messages[0].arguments;
+    ASSERT_EQ(19u, arguments.size());
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, arguments[0].type);
+    EXPECT_EQ(-1, arguments[0].int_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, arguments[1].type);
+    EXPECT_EQ(-2, arguments[1].int_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_UINT, arguments[2].type);
+    EXPECT_EQ(3u, arguments[2].uint_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_UINT, arguments[3].type);
+    EXPECT_EQ(0xFFu, arguments[3].uint_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, arguments[4].type);
+    EXPECT_EQ(-4, arguments[4].int_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_UINT, arguments[5].type);
+    EXPECT_EQ(5u, arguments[5].uint_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_UINT, arguments[6].type);
+    EXPECT_EQ(6u, arguments[6].uint_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_UINT, arguments[7].type);
+    EXPECT_EQ(0xFFu, arguments[7].uint_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_UINT, arguments[8].type);
+    EXPECT_EQ(8u, arguments[8].uint_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, arguments[9].type);
+    EXPECT_EQ(-9, arguments[9].int_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, arguments[10].type);
+    EXPECT_EQ('c', arguments[10].int_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_STRING, arguments[11].type);
+    EXPECT_EQ("string", arguments[11].string_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_STRING, arguments[12].type);
+    EXPECT_EQ("(null)", arguments[12].string_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_POINTER, arguments[13].type);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&value), arguments[13].uint_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_DOUBLE, arguments[14].type);
+    EXPECT_EQ(0.5, arguments[14].double_value);
+    // The '*' precision and width are stored before the value they apply to
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, arguments[15].type);
+    EXPECT_EQ(3, arguments[15].int_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_DOUBLE, arguments[16].type);
+    EXPECT_EQ(0.25, arguments[16].double_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, arguments[17].type);
+    EXPECT_EQ(4, arguments[17].int_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, arguments[18].type);
+    EXPECT_EQ(10, arguments[18].int_value);
+}
+
+TEST_F(TestsLog, BinaryUnknownConversion) {
+    static const char *kFormat = "%d %k %d\n";
+
+    {
+        std::unique_ptr<ProfileLayerSettings> layer_settings = CreateSettings(true);
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, kFormat, 1, 2, 3);
+    }
+
+    BinaryLog log;
+    ASSERT_TRUE(log.Read(filename_));
+
+    // The arguments after an unknown conversion can't be read reliably
+    const std::vector<BinaryLog::Message> messages = log.Find(kFormat);
+    ASSERT_EQ(1u, messages.size());
+    ASSERT_EQ(1u, messages[0].arguments.size());
+    EXPECT_EQ(1, messages[0].arguments[0].int_value);
+}
+
+TEST_F(TestsLog, BinaryLongString) {
+    static const char *kFormat = "%s %d %s\n";
+
+    const std::string long_string(8192, 'a');
+    {
+        std::unique_ptr<ProfileLayerSettings> layer_settings = CreateSettings(true);
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, kFormat, long_string.c_str(), 1, long_string.c_str());
+    }
+
+    BinaryLog log;
+    ASSERT_TRUE(log.Read(filename_));
+
+    // The strings are cut to fit the record while the following arguments are kept
+    const std::vector<BinaryLog::Message> messages = log.Find(kFormat);
+    ASSERT_EQ(1u, messages.size());
+    ASSERT_EQ(3u, messages[0].arguments.size());
+    EXPECT_EQ(BinaryLog::ARGUMENT_STRING, messages[0].arguments[0].type);
+    EXPECT_LT(messages[0].arguments[0].string_value.size(), long_string.size());
+    EXPECT_EQ(std::string(messages[0].arguments[0].string_value.size(), 'a'), messages[0].arguments[0].string_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_INT, messages[0].arguments[1].type);
+    EXPECT_EQ(1, messages[0].arguments[1].int_value);
+    EXPECT_EQ(BinaryLog::ARGUMENT_STRING, messages[0].arguments[2].type);
+    EXPECT_EQ(std::string(messages[0].arguments[2].string_value.size(), 'a'), messages[0].arguments[2].string_value);
+}
+
+TEST_F(TestsLog, BinaryFormatContents) {
+    // The same format stored at different addresses is written once, different formats stored at the same address
+    // are written twice
+    char format[64];
+    {
+        std::unique_ptr<ProfileLayerSettings> layer_settings = CreateSettings(true);
+
+        std::snprintf(format, sizeof(format), "First %%d\n");
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, format, 1);
+
+        const std::string copy = format;
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, copy.c_str(), 2);
+
+        std::snprintf(format, sizeof(format), "Second %%d\n");
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, format, 3);
+    }
+
+    BinaryLog log;
+    ASSERT_TRUE(log.Read(filename_));
+    EXPECT_EQ(2u, log.format_count);
+
+    const std::vector<BinaryLog::Message> first = log.Find("First %d\n");
+    ASSERT_EQ(2u, first.size());
+    EXPECT_EQ(1, first[0].arguments[0].int_value);
+    EXPECT_EQ(2, first[1].arguments[0].int_value);
+
+    const std::vector<BinaryLog::Message> second = log.Find("Second %d\n");
+    ASSERT_EQ(1u, second.size());
+    EXPECT_EQ(3, second[0].arguments[0].int_value);
+}
+
+TEST_F(TestsLog, BinaryFileDiscard) {
+    static const char *kFormat = "Run %d\n";
+
+    {
+        std::unique_ptr<ProfileLayerSettings> layer_settings = CreateSettings(true);
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, kFormat, 0);
+    }
+
+    // Each run appends its own header, the format identifiers restart from zero
+    for (int run = 1; run < 3; ++run) {
+        std::unique_ptr<ProfileLayerSettings> layer_settings = CreateSettings(false);
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, kFormat, run);
+    }
+
+    {
+        BinaryLog log;
+        ASSERT_TRUE(log.Read(filename_));
+        EXPECT_EQ(3u, log.header_count);
+
+        const std::vector<BinaryLog::Message> messages = log.Find(kFormat);
+        ASSERT_EQ(3u, messages.size());
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            EXPECT_EQ(static_cast<int64_t>(i), messages[i].arguments[0].int_value);
+        }
+    }
+
+    {
+        std::unique_ptr<ProfileLayerSettings> layer_settings = CreateSettings(true);
+        LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, kFormat, 3);
+    }
+
+    {
+        BinaryLog log;
+        ASSERT_TRUE(log.Read(filename_));
+        EXPECT_EQ(1u, log.header_count);
+
+        const std::vector<BinaryLog::Message> messages = log.Find(kFormat);
+        ASSERT_EQ(1u, messages.size());
+        EXPECT_EQ(3, messages[0].arguments[0].int_value);
+    }
+}
+
+TEST_F(TestsLog, AsyncFlush) {
+    std::unique_ptr<ProfileLayerSettings> layer_settings = CreateAsyncSettings();
+    ASSERT_NE(nullptr, layer_settings->log.async_writer);
+
+    // The messages pushed before a flush are in the file when the flush returns
+    int count = 0;
+    for (int flush = 0; flush < 8; ++flush) {
+        for (int i = 0; i < (1 << flush); ++i, ++count) {
+            LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, "Thread %d message %d\n", 0, count);
+        }
+        LogFlush(layer_settings.get());
+
+        ExpectSequence(ReadAsyncMessages(1)[0], count);
+    }
+}
+
+TEST_F(TestsLog, AsyncFullRing) {
+    static const int kThreadCount = 4;
+    static const int kMessageCount = 4096;  // Many times the size of the ring
+
+    std::unique_ptr<ProfileLayerSettings> layer_settings = CreateAsyncSettings();
+    ASSERT_NE(nullptr, layer_settings->log.async_writer);
+
+    // When the ring is full, the threads wait for the writer thread instead of dropping the messages
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kThreadCount; ++thread) {
+        threads.emplace_back([&layer_settings, thread]() {
+            for (int i = 0; i < kMessageCount; ++i) {
+                LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, "Thread %d message %d\n", thread, i);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    LogFlush(layer_settings.get());
+
+    // The messages of each thread are written in order
+    const std::vector<std::vector<int>> messages = ReadAsyncMessages(kThreadCount);
+    for (int thread = 0; thread < kThreadCount; ++thread) {
+        ExpectSequence(messages[thread], kMessageCount);
+    }
+}
+
+TEST_F(TestsLog, AsyncDestroy) {
+    static const int kMessageCount = 1024;
+
+    {
+        std::unique_ptr<ProfileLayerSettings> layer_settings = CreateAsyncSettings();
+        ASSERT_NE(nullptr, layer_settings->log.async_writer);
+
+        for (int i = 0; i < kMessageCount; ++i) {
+            LogMessage(layer_settings.get(), DEBUG_REPORT_ERROR_BIT, "Thread %d message %d\n", 0, i);
+        }
+    }
+
+    // The pending messages are written before the log file is closed
+    ExpectSequence(ReadAsyncMessages(1)[0], kMessageCount);
+}
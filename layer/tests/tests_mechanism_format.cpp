@@ -27,6 +27,11 @@
 #include "profiles_test_helper.h"
 
 #include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
 
 class TestsMechanismFormat : public VkTestFramework {
    public:
@@ -273,3 +278,107 @@ TEST_F(TestsMechanismFormat, TestParsingAllFormatProperties) {
     }
 #endif
 }
+
+TEST_F(TestsMechanismFormat, TestImageFormatCache) {
+    TEST_DESCRIPTION("Test that the image format cache answers the repeated queries without calling the driver");
+
+    VkResult err = VK_SUCCESS;
+
+    profiles_test::VulkanInstanceBuilder inst_builder;
+
+    const std::string log_path = (std::filesystem::temp_directory_path() / "vk_profiles_image_format_cache.txt").generic_string();
+
+    const char* profile_file_data = JSON_TEST_FILES_PATH "VP_LUNARG_test_baseline_formats.json";
+    const char* profile_name_data = "VP_LUNARG_test_formats";
+    VkBool32 emulate_portability_data = VK_TRUE;
+    const std::vector<const char*> simulate_capabilities = {"SIMULATE_FORMATS_BIT"};
+    const uint32_t image_format_cache_size = 1;
+    const char* debug_actions = "DEBUG_ACTION_FILE_BIT";
+    const char* debug_filename = log_path.c_str();
+    VkBool32 debug_file_clear = VK_TRUE;
+    const char* debug_reports = "DEBUG_REPORT_NOTIFICATION_BIT";
+
+    std::vector<VkLayerSettingEXT> settings = {
+        {kLayerName, kLayerSettingsProfileFile, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &profile_file_data},
+        {kLayerName, kLayerSettingsProfileName, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &profile_name_data},
+        {kLayerName, kLayerSettingsEmulatePortability, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &emulate_portability_data},
+        {kLayerName, kLayerSettingsSimulateCapabilities, VK_LAYER_SETTING_TYPE_STRING_EXT,
+         static_cast<uint32_t>(simulate_capabilities.size()), &simulate_capabilities[0]},
+        {kLayerName, kLayerSettingsImageFormatCacheSize, VK_LAYER_SETTING_TYPE_UINT32_EXT, 1, &image_format_cache_size},
+        {kLayerName, kLayerSettingsDebugActions, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &debug_actions},
+        {kLayerName, kLayerSettingsDebugFilename, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &debug_filename},
+        {kLayerName, kLayerSettingsDebugFileClear, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &debug_file_clear},
+        {kLayerName, kLayerSettingsDebugReports, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &debug_reports}};
+
+    err = inst_builder.init(VK_API_VERSION_1_1, settings);
+    ASSERT_EQ(err, VK_SUCCESS);
+
+    VkPhysicalDevice gpu;
+    err = inst_builder.getPhysicalDevice(profiles_test::MODE_PROFILE, &gpu);
+    if (err != VK_SUCCESS) {
+        printf("Profile not supported on device, skipping test.\n");
+        return;
+    }
+
+    const VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    // The second identical query is answered by the cache
+    VkImageFormatProperties first_properties{};
+    const VkResult first_result = vkGetPhysicalDeviceImageFormatProperties(
+        gpu, format, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, 0, &first_properties);
+    VkImageFormatProperties second_properties{};
+    const VkResult second_result = vkGetPhysicalDeviceImageFormatProperties(
+        gpu, format, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, 0, &second_properties);
+    EXPECT_EQ(first_result, second_result);
+    EXPECT_EQ(0, memcmp(&first_properties, &second_properties, sizeof(VkImageFormatProperties)));
+
+    // The cache is full, the other queries call the driver every time
+    for (int i = 0; i < 2; ++i) {
+        VkImageFormatProperties properties{};
+        vkGetPhysicalDeviceImageFormatProperties(gpu, format, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
+                                                 VK_IMAGE_USAGE_TRANSFER_DST_BIT, 0, &properties);
+    }
+
+    // The structures chained to the query are not part of the cache key, so chained queries bypass the cache
+    for (int i = 0; i < 2; ++i) {
+        VkPhysicalDeviceImageFormatInfo2 format_info{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2};
+        format_info.format = format;
+        format_info.type = VK_IMAGE_TYPE_2D;
+        format_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        format_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+        VkSamplerYcbcrConversionImageFormatProperties ycbcr_properties{
+            VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_IMAGE_FORMAT_PROPERTIES};
+        VkImageFormatProperties2 properties2{VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2, &ycbcr_properties};
+        vkGetPhysicalDeviceImageFormatProperties2(gpu, &format_info, &properties2);
+    }
+
+    // The statistics of the cache are logged when the instance is destroyed
+    inst_builder.reset();
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    std::size_t entries = 0;
+    std::ifstream log(log_path);
+    for (std::string line; std::getline(log, line);) {
+        const std::size_t position = line.find("Image format cache of");
+        if (position == std::string::npos) {
+            continue;
+        }
+        unsigned long long device_hits = 0;
+        unsigned long long device_misses = 0;
+        std::size_t device_entries = 0;
+        const std::size_t statistics = line.find("\": ", position);
+        ASSERT_NE(statistics, std::string::npos);
+        ASSERT_EQ(3, sscanf(line.c_str() + statistics + 3, "%llu hits, %llu misses, %zu entries.", &device_hits,
+                            &device_misses, &device_entries));
+        hits += device_hits;
+        misses += device_misses;
+        entries += device_entries;
+    }
+    log.close();
+    std::remove(log_path.c_str());
+
+    EXPECT_EQ(hits, 1);
+    EXPECT_EQ(misses, 3);
+    EXPECT_EQ(entries, 1);
+}
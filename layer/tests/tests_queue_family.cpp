@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026-2026 Valve Corporation
+ * Copyright (C) 2026-2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Author: Christophe Riccio <christophe@lunarg.com>
+ */
+
+#include <gtest/gtest.h>
+#include "../profiles_util.h"
+
+#include <vector>
+
+// Compatibility of each device queue family, by rows, with each profile queue family, by columns
+static std::vector<std::vector<bool>> Compatible(const std::vector<std::vector<int>> &rows) {
+    std::vector<std::vector<bool>> compatible;
+    for (const auto &row : rows) {
+        compatible.emplace_back(row.begin(), row.end());
+    }
+    return compatible;
+}
+
+TEST(TestsQueueFamily, InOrder) {
+    std::vector<std::size_t> assignment;
+    ASSERT_TRUE(MatchQueueFamilies(Compatible({{1, 1}, {1, 1}}), 2, &assignment));
+    EXPECT_EQ(assignment, (std::vector<std::size_t>{0, 1}));
+}
+
+TEST(TestsQueueFamily, AugmentingPath) {
+    // Greedily matching the profile queue family 0 with the device queue family 0 leaves nothing for the profile queue family 1
+    std::vector<std::size_t> assignment;
+    ASSERT_TRUE(MatchQueueFamilies(Compatible({{1, 1}, {1, 0}}), 2, &assignment));
+    EXPECT_EQ(assignment, (std::vector<std::size_t>{1, 0}));
+}
+
+TEST(TestsQueueFamily, LongAugmentingPath) {
+    std::vector<std::size_t> assignment;
+    ASSERT_TRUE(MatchQueueFamilies(Compatible({{1, 1, 1}, {1, 1, 0}, {1, 0, 0}}), 3, &assignment));
+    EXPECT_EQ(assignment, (std::vector<std::size_t>{2, 1, 0}));
+}
+
+TEST(TestsQueueFamily, UnusedDeviceQueueFamilies) {
+    std::vector<std::size_t> assignment;
+    ASSERT_TRUE(MatchQueueFamilies(Compatible({{0, 0}, {1, 1}, {0, 0}, {1, 0}, {0, 0}}), 2, &assignment));
+    EXPECT_EQ(assignment, (std::vector<std::size_t>{SIZE_MAX, 1, SIZE_MAX, 0, SIZE_MAX}));
+}
+
+TEST(TestsQueueFamily, NotSimultaneously) {
+    // Each profile queue family is supported individually, but two of them only by the same device queue family
+    std::vector<std::size_t> assignment;
+    EXPECT_FALSE(MatchQueueFamilies(Compatible({{1, 1}, {0, 0}}), 2, &assignment));
+    EXPECT_FALSE(MatchQueueFamilies(Compatible({{1, 1, 1}, {0, 0, 1}, {0, 0, 1}}), 3, &assignment));
+}
+
+TEST(TestsQueueFamily, NoProfileQueueFamily) {
+    std::vector<std::size_t> assignment;
+    ASSERT_TRUE(MatchQueueFamilies(Compatible({{}, {}}), 0, &assignment));
+    EXPECT_EQ(assignment, (std::vector<std::size_t>{SIZE_MAX, SIZE_MAX}));
+}
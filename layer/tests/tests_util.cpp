@@ -30,6 +30,7 @@ TEST(TestsUtil, DebugAction) {
     EXPECT_STREQ("DEBUG_ACTION_STDOUT_BIT", strings[1].c_str());
     EXPECT_STREQ("DEBUG_ACTION_OUTPUT_BIT", strings[2].c_str());
     EXPECT_STREQ("DEBUG_ACTION_BREAKPOINT_BIT", strings[3].c_str());
+    EXPECT_STREQ("DEBUG_ACTION_BINARY_FILE_BIT", strings[4].c_str());
 
     DebugActionFlags flags = GetDebugActionFlags(strings);
 
@@ -37,6 +38,7 @@ TEST(TestsUtil, DebugAction) {
     EXPECT_TRUE(flags & DEBUG_ACTION_STDOUT_BIT);
     EXPECT_TRUE(flags & DEBUG_ACTION_OUTPUT_BIT);
     EXPECT_TRUE(flags & DEBUG_ACTION_BREAKPOINT_BIT);
+    EXPECT_TRUE(flags & DEBUG_ACTION_BINARY_FILE_BIT);
 }
 
 static std::vector<std::string> GetDebugReportStrings(DebugReportFlags flags) {
@@ -24,6 +24,8 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
+#include <algorithm>
 
 #define VP_DEBUG_MESSAGE_CALLBACK mockDebugMessageCallback
 
@@ -32,13 +34,17 @@ class MockDebugMessageCallback final
 private:
     std::vector<std::string>            m_expectedMessages;
     size_t                              m_matchedMessages;
+    bool                                m_ordered;
+    std::mutex                          m_mutex;
 
     static MockDebugMessageCallback*    sInstance;
 
 public:
-    MockDebugMessageCallback(std::vector<std::string>&& messages)
+    // When the messages are emitted from several threads, their order is not checked
+    MockDebugMessageCallback(std::vector<std::string>&& messages, bool ordered = true)
         : m_expectedMessages{ std::move(messages) }
         , m_matchedMessages{ 0 }
+        , m_ordered{ ordered }
     {
         sInstance = this;
     }
@@ -53,7 +59,17 @@ public:
     {
         EXPECT_NE(sInstance, nullptr) << "No debug message callback mock is configured";
         if (sInstance != nullptr) {
-            if (sInstance->m_matchedMessages < sInstance->m_expectedMessages.size()) {
+            std::lock_guard<std::mutex> lock(sInstance->m_mutex);
+            if (!sInstance->m_ordered) {
+                auto begin = sInstance->m_expectedMessages.begin() + sInstance->m_matchedMessages;
+                auto it = std::find(begin, sInstance->m_expectedMessages.end(), pMessage);
+                if (it != sInstance->m_expectedMessages.end()) {
+                    std::iter_swap(begin, it);
+                    ++sInstance->m_matchedMessages;
+                } else {
+                    EXPECT_TRUE(false) << "Unexpected debug message: " << pMessage;
+                }
+            } else if (sInstance->m_matchedMessages < sInstance->m_expectedMessages.size()) {
                 const char* pExpected = sInstance->m_expectedMessages[sInstance->m_matchedMessages++].c_str();
                 EXPECT_STREQ(pMessage, pExpected);
             } else {
@@ -26,6 +26,8 @@
 #include <vulkan/vulkan_core.h>
 
 #include <string.h>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <tuple>
 #include <unordered_map>
@@ -119,6 +121,7 @@ private:
     std::unordered_map<VkInstance, std::unordered_map<std::string, PFN_vkVoidFunction>> m_instanceProcAddr;
     std::unordered_map<std::string, std::vector<VkExtensionProperties>>                 m_instanceExtensions;
     std::unordered_map<VkPhysicalDevice, std::vector<VkExtensionProperties>>            m_deviceExtensions;
+    std::vector<VkPhysicalDevice>                                                       m_physicalDevices;
 
     uint32_t                            m_instanceAPIVersion;
     const VkInstanceCreateInfo*         m_pInstanceCreateInfo;
@@ -140,8 +143,18 @@ private:
     MockedVideoStructData                           m_mockedVideoCapabilities;
     MockedVideoStructData                           m_mockedVideoFormats;
 
+    // Number of calls of the physical device queries, which may be called from several threads
+    std::unordered_map<std::string, uint32_t>       m_callCounts;
+    std::mutex                                      m_callCountMutex;
+
     static MockVulkanAPI*   sInstance;
 
+    void CountCall(const char* pName)
+    {
+        std::lock_guard<std::mutex> lock(m_callCountMutex);
+        ++m_callCounts[pName];
+    }
+
     const VkBaseOutStructure* GetStructure(const void* pNext, VkStructureType type)
     {
         const VkBaseOutStructure *p = static_cast<const VkBaseOutStructure*>(pNext);
@@ -187,6 +200,7 @@ public:
         : m_instanceProcAddr{}
         , m_instanceExtensions{}
         , m_deviceExtensions{}
+        , m_physicalDevices{}
         , m_instanceAPIVersion{ VK_API_VERSION_1_0 }
         , m_pInstanceCreateInfo{}
         , m_instanceCreateStructs{}
@@ -204,6 +218,9 @@ public:
     {
         sInstance = this;
 
+        m_physicalDevices.push_back(vkPhysicalDevice);
+        AddInstanceProc(vkInstance, "vkEnumeratePhysicalDevices", &vkEnumeratePhysicalDevices);
+
         VpFunctionsCreateInfo functionsCreateInfo{};
         functionsCreateInfo.GetInstanceProcAddr = MockVulkanAPI::vkGetInstanceProcAddr;
         functionsCreateInfo.EnumerateInstanceVersion = MockVulkanAPI::vkEnumerateInstanceVersion;
@@ -227,6 +244,20 @@ public:
         sInstance = nullptr;
     }
 
+    // The 2KHR entry points are counted with their core name
+    uint32_t GetCallCount(const char* pName)
+    {
+        std::lock_guard<std::mutex> lock(m_callCountMutex);
+        auto it = m_callCounts.find(pName);
+        return it != m_callCounts.end() ? it->second : 0;
+    }
+
+    void ResetCallCounts()
+    {
+        std::lock_guard<std::mutex> lock(m_callCountMutex);
+        m_callCounts.clear();
+    }
+
     void ClearProfileAreas(int profileAreas) {
         if (profileAreas & PROFILE_AREA_EXTENSIONS_BIT) {
             this->m_instanceExtensions.clear();
@@ -352,6 +383,40 @@ public:
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
+    static VKAPI_ATTR VkResult VKAPI_CALL vkEnumeratePhysicalDevices(
+        VkInstance                                  instance,
+        uint32_t*                                   pPhysicalDeviceCount,
+        VkPhysicalDevice*                           pPhysicalDevices)
+    {
+        EXPECT_NE(sInstance, nullptr) << "No Vulkan API mock is configured";
+        if (sInstance != nullptr) {
+            EXPECT_EQ(instance, sInstance->vkInstance);
+            const auto& physicalDevices = sInstance->m_physicalDevices;
+            VkResult result = VK_SUCCESS;
+            if (pPhysicalDevices == nullptr) {
+                *pPhysicalDeviceCount = static_cast<uint32_t>(physicalDevices.size());
+            } else {
+                if (*pPhysicalDeviceCount < physicalDevices.size()) {
+                    result = VK_INCOMPLETE;
+                } else {
+                    *pPhysicalDeviceCount = static_cast<uint32_t>(physicalDevices.size());
+                }
+                for (uint32_t i = 0; i < *pPhysicalDeviceCount; ++i) {
+                    pPhysicalDevices[i] = physicalDevices[i];
+                }
+            }
+            return result;
+        }
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // The physical devices are enumerated in the order they are added, after vkPhysicalDevice. They share the features,
+    // properties, formats and queue families, only their extensions differ.
+    void AddPhysicalDevice(VkPhysicalDevice physicalDevice)
+    {
+        m_physicalDevices.push_back(physicalDevice);
+    }
+
     void SetDeviceExtensions(VkPhysicalDevice physicalDevice, const std::vector<VkExtensionProperties>& extensions)
     {
         m_deviceExtensions[physicalDevice] = extensions;
@@ -367,6 +432,7 @@ public:
 
         EXPECT_NE(sInstance, nullptr) << "No Vulkan API mock is configured";
         if (sInstance != nullptr) {
+            sInstance->CountCall("vkEnumerateDeviceExtensionProperties");
             VkResult result = VK_SUCCESS;
             auto it = sInstance->m_deviceExtensions.find(physicalDevice);
             if (it != sInstance->m_deviceExtensions.end()) {
@@ -481,6 +547,7 @@ public:
 
         EXPECT_NE(sInstance, nullptr) << "No Vulkan API mock is configured";
         if (sInstance != nullptr) {
+            sInstance->CountCall("vkGetPhysicalDeviceProperties");
             pProperties->apiVersion = sInstance->m_deviceAPIVersion;
         }
     }
@@ -500,6 +567,7 @@ public:
 
         EXPECT_NE(sInstance, nullptr) << "No Vulkan API mock is configured";
         if (sInstance != nullptr) {
+            sInstance->CountCall("vkGetPhysicalDeviceFeatures2");
             VkBaseOutStructure* p = static_cast<VkBaseOutStructure*>(static_cast<void*>(pFeatures));
             while (p != nullptr) {
                 auto it = sInstance->m_mockedFeatures.find(p->sType);
@@ -526,6 +594,7 @@ public:
 
         EXPECT_NE(sInstance, nullptr) << "No Vulkan API mock is configured";
         if (sInstance != nullptr) {
+            sInstance->CountCall("vkGetPhysicalDeviceProperties2");
             VkBaseOutStructure* p = static_cast<VkBaseOutStructure*>(static_cast<void*>(pProperties));
             while (p != nullptr) {
                 auto it = sInstance->m_mockedProperties.find(p->sType);
@@ -557,6 +626,7 @@ public:
 
         EXPECT_NE(sInstance, nullptr) << "No Vulkan API mock is configured";
         if (sInstance != nullptr) {
+            sInstance->CountCall("vkGetPhysicalDeviceFormatProperties2");
             auto fmtIt = sInstance->m_mockedFormats.find(format);
             if (fmtIt != sInstance->m_mockedFormats.end()) {
                 auto& mockedFormat = fmtIt->second;
@@ -590,6 +660,7 @@ public:
 
         EXPECT_NE(sInstance, nullptr) << "No Vulkan API mock is configured";
         if (sInstance != nullptr) {
+            sInstance->CountCall("vkGetPhysicalDeviceQueueFamilyProperties2");
             if (pQueueFamilyProperties == nullptr) {
                 *pQueueFamilyPropertyCount = static_cast<uint32_t>(sInstance->m_mockedQueueFamilies.size());
             } else {
@@ -226,10 +226,18 @@ TEST(mocked_api_generated_library, internal_code) {
 
     features.Build(structureTypes);
 
+    // Only the required structures are chained
+    EXPECT_NE(detail::vpGetStructure(&features.requiredFeaturesChain, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES), nullptr);
+    EXPECT_EQ(detail::vpGetStructure(&features.requiredFeaturesChain, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETERS_FEATURES), nullptr);
+
+    VkPhysicalDeviceVulkan11Features* pFeatures11 = static_cast<VkPhysicalDeviceVulkan11Features*>(
+        detail::vpGetStructure(&features.requiredFeaturesChain, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES));
+    ASSERT_NE(pFeatures11, nullptr);
+
     features.requiredFeaturesChain.features.depthClamp = VK_TRUE;
     features.requiredFeaturesChain.features.depthBiasClamp = VK_TRUE;
-    features.physicalDeviceVulkan11Features.storageBuffer16BitAccess = VK_TRUE;
-    features.physicalDeviceVulkan11Features.uniformAndStorageBuffer16BitAccess = VK_TRUE;
+    pFeatures11->storageBuffer16BitAccess = VK_TRUE;
+    pFeatures11->uniformAndStorageBuffer16BitAccess = VK_TRUE;
 
     VkDeviceCreateInfo VkCreateInfo{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO, &outFeatures};
     VpDeviceCreateInfo VpCreateInfo{&VkCreateInfo, 0};
@@ -241,9 +249,9 @@ TEST(mocked_api_generated_library, internal_code) {
     EXPECT_EQ(features.requiredFeaturesChain.features.depthClamp, VK_TRUE);
     EXPECT_EQ(features.requiredFeaturesChain.features.depthBiasClamp, VK_TRUE);
 
-    EXPECT_EQ(features.physicalDeviceVulkan11Features.storageBuffer16BitAccess, VK_TRUE);
-    EXPECT_EQ(features.physicalDeviceVulkan11Features.shaderDrawParameters, VK_TRUE);
-    EXPECT_EQ(features.physicalDeviceVulkan11Features.uniformAndStorageBuffer16BitAccess, VK_TRUE);
+    EXPECT_EQ(pFeatures11->storageBuffer16BitAccess, VK_TRUE);
+    EXPECT_EQ(pFeatures11->shaderDrawParameters, VK_TRUE);
+    EXPECT_EQ(pFeatures11->uniformAndStorageBuffer16BitAccess, VK_TRUE);
 }
 
 TEST(mocked_api_generated_library, create_device) {
@@ -807,6 +815,39 @@ TEST(mocked_api_generated_library, check_support_variants_queue_family_reflectio
     EXPECT_EQ(structure_types[1], VK_STRUCTURE_TYPE_QUEUE_FAMILY_PROPERTIES_2);
 }
 
+TEST(mocked_api_generated_library, check_support_duplicated_block_reflection) {
+    MockVulkanAPI mock;
+
+    // "block" is listed alone and as a variant of a capability group, the queries filtered by block name use both
+    const VpProfileProperties profile{VP_LUNARG_TEST_DUPLICATED_BLOCK_NAME, VP_LUNARG_TEST_DUPLICATED_BLOCK_SPEC_VERSION};
+
+    VkResult result = VK_SUCCESS;
+    uint32_t queue_family_count = 0;
+    std::vector<VkQueueFamilyProperties2KHR> props{};
+
+    result = vpGetProfileQueueFamilyProperties(mock.functions, &profile, "block", &queue_family_count, nullptr);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(queue_family_count, 2);
+
+    props.resize(queue_family_count, {VK_STRUCTURE_TYPE_QUEUE_FAMILY_PROPERTIES_2, nullptr});
+    result = vpGetProfileQueueFamilyProperties(mock.functions, &profile, "block", &queue_family_count, props.data());
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(queue_family_count, 2);
+
+    EXPECT_EQ(props[0].queueFamilyProperties.queueFlags, VK_QUEUE_TRANSFER_BIT);
+    EXPECT_EQ(props[1].queueFamilyProperties.queueFlags, VK_QUEUE_TRANSFER_BIT);
+
+    result = vpGetProfileQueueFamilyProperties(mock.functions, &profile, "variant", &queue_family_count, nullptr);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(queue_family_count, 1);
+
+    VkPhysicalDeviceFeatures2 features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, nullptr};
+    result = vpGetProfileFeatures(mock.functions, &profile, "block", &features);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(features.features.depthClamp, VK_TRUE);
+    EXPECT_EQ(features.features.fullDrawIndexUint32, VK_FALSE);
+}
+
 TEST(mocked_api_generated_library, check_support_variants_format_reflection) {
     MockVulkanAPI mock;
     VkResult result = VK_SUCCESS;
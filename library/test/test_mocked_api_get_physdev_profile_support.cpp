@@ -23,6 +23,10 @@
 #define VP_USE_OBJECT 1
 #endif
 
+#ifndef VP_USE_THREADS
+#define VP_USE_THREADS 1
+#endif
+
 #include <vulkan/vulkan_core.h>
 #include <vulkan/vulkan_android.h>
 
@@ -36,6 +40,109 @@
 
 #include "mock_vulkan_api.hpp"
 
+// Vulkan 1.0 physical device of the mock supporting VP_ANDROID_baseline_2021, the tests modify its extensions and features
+// to make the profile unsupported
+class AndroidBaseline2021Device {
+public:
+    explicit AndroidBaseline2021Device(MockVulkanAPI& mock) : mock(mock) {
+        mock.SetInstanceAPIVersion(VK_API_VERSION_1_0);
+        mock.SetDeviceAPIVersion(VK_API_VERSION_1_0);
+        mock.SetDeviceExtensions(mock.vkPhysicalDevice, extensions);
+
+        vpGetProfileFeatures(mock.functions, &profile, nullptr, &features);
+        features.features.dualSrcBlend = VK_TRUE;
+        features.features.drawIndirectFirstInstance = VK_TRUE;
+        multiviewFeatures.multiview = VK_TRUE;
+        SetFeatures();
+
+        VkPhysicalDeviceMultiviewPropertiesKHR multiviewProps{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES_KHR };
+        VkPhysicalDeviceProperties2KHR props{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR, &multiviewProps };
+        vpGetProfileProperties(mock.functions, &profile, nullptr, &props);
+        props.properties.limits.maxImageDimension2D = 16384;
+        props.properties.limits.maxBoundDescriptorSets = 8;
+        props.properties.limits.subPixelPrecisionBits = 8;
+        props.properties.limits.maxViewports = 4;
+        props.properties.limits.viewportBoundsRange[0] = -16384;
+        props.properties.limits.viewportBoundsRange[1] = 16384;
+        props.properties.limits.framebufferColorSampleCounts |= VK_SAMPLE_COUNT_2_BIT;
+        props.properties.limits.pointSizeRange[0] = 1.f;
+        props.properties.limits.pointSizeRange[1] = 32.f;
+        props.properties.limits.pointSizeGranularity = 0.125f;
+        multiviewProps.maxMultiviewViewCount = 6;
+        multiviewProps.maxMultiviewInstanceIndex = 65536;
+        mock.SetProperties({
+            VK_STRUCT(props),
+            VK_STRUCT(multiviewProps)
+        });
+
+        uint32_t formatCount;
+        vpGetProfileFormats(mock.functions, &profile, nullptr, &formatCount, nullptr);
+        std::vector<VkFormat> formats(formatCount);
+        vpGetProfileFormats(mock.functions, &profile, nullptr, &formatCount, formats.data());
+        for (size_t i = 0; i < formatCount; ++i) {
+            VkFormatProperties2KHR formatProps{ VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2_KHR };
+            vpGetProfileFormatProperties(mock.functions, &profile, nullptr, formats[i], &formatProps);
+            formatProps.formatProperties.optimalTilingFeatures |= VK_FORMAT_FEATURE_BLIT_SRC_BIT;
+            formatProps.formatProperties.bufferFeatures |= VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT;
+            mock.AddFormat(formats[i], { VK_STRUCT(formatProps) });
+        }
+
+        VkQueueFamilyProperties2KHR queueFamilyProps{ VK_STRUCTURE_TYPE_QUEUE_FAMILY_PROPERTIES_2_KHR };
+        queueFamilyProps.queueFamilyProperties.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+        queueFamilyProps.queueFamilyProperties.queueCount = 2;
+        queueFamilyProps.queueFamilyProperties.timestampValidBits = 63;
+        queueFamilyProps.queueFamilyProperties.minImageTransferGranularity = { 1, 1, 1 };
+        mock.AddQueueFamily({ VK_STRUCT(queueFamilyProps) });
+    }
+
+    AndroidBaseline2021Device(const AndroidBaseline2021Device&) = delete;
+    AndroidBaseline2021Device& operator=(const AndroidBaseline2021Device&) = delete;
+
+    // Replace the features of the mock by the current values of the features
+    void SetFeatures() {
+        mock.ClearProfileAreas(PROFILE_AREA_FEATURES_BIT);
+        mock.SetFeatures({
+            VK_STRUCT(features),
+            VK_STRUCT(multiviewFeatures)
+        });
+    }
+
+    // Remove one of the device extensions of a physical device
+    void RemoveExtension(VkPhysicalDevice physicalDevice, const char* extensionName) {
+        std::vector<VkExtensionProperties> remaining;
+        for (const VkExtensionProperties& extension : extensions) {
+            if (strcmp(extension.extensionName, extensionName) != 0) {
+                remaining.push_back(extension);
+            }
+        }
+        mock.SetDeviceExtensions(physicalDevice, remaining);
+    }
+
+    MockVulkanAPI& mock;
+    const VpProfileProperties profile{ VP_ANDROID_BASELINE_2021_NAME, VP_ANDROID_BASELINE_2021_SPEC_VERSION };
+    const std::vector<VkExtensionProperties> extensions{
+        VK_EXT(VK_KHR_SWAPCHAIN),
+        VK_EXT(VK_KHR_MAINTENANCE_1),
+        VK_EXT(VK_KHR_MAINTENANCE_2),
+        VK_EXT(VK_KHR_INCREMENTAL_PRESENT),
+        VK_EXT(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE),
+        VK_EXT(VK_KHR_GET_MEMORY_REQUIREMENTS_2),
+        VK_EXT(VK_KHR_DEDICATED_ALLOCATION),
+        VK_EXT(VK_KHR_STORAGE_BUFFER_STORAGE_CLASS),
+        VK_EXT(VK_KHR_VARIABLE_POINTERS),
+        VK_EXT(VK_KHR_EXTERNAL_SEMAPHORE),
+        VK_EXT(VK_KHR_EXTERNAL_SEMAPHORE_FD),
+        VK_EXT(VK_KHR_EXTERNAL_MEMORY),
+        VK_EXT(VK_KHR_EXTERNAL_MEMORY_FD),
+        VK_EXT(VK_KHR_EXTERNAL_FENCE),
+        VK_EXT(VK_KHR_EXTERNAL_FENCE_FD),
+        VK_EXT(VK_EXT_DESCRIPTOR_INDEXING),
+        VK_EXT(VK_GOOGLE_DISPLAY_TIMING),
+    };
+    VkPhysicalDeviceMultiviewFeaturesKHR multiviewFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR };
+    VkPhysicalDeviceFeatures2KHR features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR, &multiviewFeatures };
+};
+
 TEST(mocked_api_get_physdev_profile_support, vulkan10_supported) {
     MockVulkanAPI mock;
 
@@ -126,6 +233,228 @@ TEST(mocked_api_get_physdev_profile_support, vulkan10_supported) {
     EXPECT_EQ(supported, VK_TRUE);
 }
 
+TEST(mocked_api_get_physdev_profile_support, vulkan10_batch) {
+    MockVulkanAPI mock;
+
+#ifdef WITH_DEBUG_MESSAGES
+    const char* unsupportedExtension = "Unsupported extension: VK_GOOGLE_display_timing";
+    const char* unsupportedVersion = "Unsupported requested VP_ANDROID_baseline_2021 profile version: 4, profile supported at version 3";
+    MockDebugMessageCallback cb({
+        unsupportedVersion,
+        unsupportedVersion,
+        unsupportedExtension, unsupportedVersion, unsupportedExtension,
+        unsupportedExtension, unsupportedVersion, unsupportedExtension,
+        unsupportedExtension, unsupportedVersion, unsupportedExtension
+    });
+#endif
+
+    AndroidBaseline2021Device device(mock);
+
+    // The second profile requests a newer version of the profile than the library supports
+    const VpProfileProperties profiles[] = {
+        device.profile,
+        { VP_ANDROID_BASELINE_2021_NAME, VP_ANDROID_BASELINE_2021_SPEC_VERSION + 1 }
+    };
+
+    // The queue family count is the last one, the snapshot of the batch queries it even without a queue family requirement
+    const std::vector<const char*> countedCalls{
+        "vkEnumerateDeviceExtensionProperties",
+        "vkGetPhysicalDeviceProperties",
+        "vkGetPhysicalDeviceFeatures2",
+        "vkGetPhysicalDeviceProperties2",
+        "vkGetPhysicalDeviceFormatProperties2",
+        "vkGetPhysicalDeviceQueueFamilyProperties2"
+    };
+    const std::size_t featuresCall = 2;
+    const std::size_t formatCall = 4;
+    auto takeCallCounts = [&]() {
+        std::vector<uint32_t> counts;
+        for (const char* name : countedCalls) {
+            counts.push_back(mock.GetCallCount(name));
+        }
+        mock.ResetCallCounts();
+        return counts;
+    };
+
+    VkBool32 supported[2] = { VK_FALSE, VK_TRUE };
+    uint32_t blockCount = 0;
+    VkResult result = VK_SUCCESS;
+
+    // Each profile checked on its own queries the driver again
+    mock.ResetCallCounts();
+    for (uint32_t i = 0; i < 2; ++i) {
+        result = vpGetPhysicalDeviceProfileSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, &profiles[i], &supported[i]);
+        EXPECT_EQ(result, VK_SUCCESS);
+    }
+    EXPECT_EQ(supported[0], VK_TRUE);
+    EXPECT_EQ(supported[1], VK_FALSE);
+    const std::vector<uint32_t> separateCounts = takeCallCounts();
+
+    result = vpGetPhysicalDeviceProfilesSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, 1, profiles, supported, &blockCount, nullptr);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(supported[0], VK_TRUE);
+    EXPECT_EQ(blockCount, 0);
+    const std::vector<uint32_t> singleCounts = takeCallCounts();
+
+    supported[0] = VK_FALSE;
+    supported[1] = VK_TRUE;
+    result = vpGetPhysicalDeviceProfilesSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, 2, profiles, supported, &blockCount, nullptr);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(supported[0], VK_TRUE);
+    EXPECT_EQ(supported[1], VK_FALSE);
+    EXPECT_EQ(blockCount, 0);
+    const std::vector<uint32_t> batchCounts = takeCallCounts();
+
+    // The second profile of the batch is checked with the values queried for the first profile
+    uint32_t separateTotal = 0;
+    uint32_t batchTotal = 0;
+    for (std::size_t i = 0; i < countedCalls.size(); ++i) {
+        EXPECT_EQ(batchCounts[i], singleCounts[i]) << countedCalls[i];
+        separateTotal += separateCounts[i];
+        batchTotal += batchCounts[i];
+    }
+    EXPECT_GT(batchCounts[featuresCall], 0u);
+    EXPECT_GT(batchCounts[formatCall], 0u);
+    for (std::size_t i = 0; i + 1 < countedCalls.size(); ++i) {
+        EXPECT_LE(batchCounts[i], separateCounts[i]) << countedCalls[i];
+    }
+    EXPECT_LT(batchTotal, separateTotal);
+
+    // Without an extension of the profile, the blocks of both profile versions are reported
+    device.RemoveExtension(mock.vkPhysicalDevice, VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+
+    supported[0] = VK_TRUE;
+    supported[1] = VK_TRUE;
+    blockCount = 0;
+    result = vpGetPhysicalDeviceProfilesSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, 2, profiles, supported, &blockCount, nullptr);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(supported[0], VK_FALSE);
+    EXPECT_EQ(supported[1], VK_FALSE);
+    ASSERT_GE(blockCount, 2u);
+
+    std::vector<VpBlockProperties> blocks(blockCount);
+    result = vpGetPhysicalDeviceProfilesSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, 2, profiles, supported, &blockCount, blocks.data());
+    EXPECT_EQ(result, VK_SUCCESS);
+    ASSERT_EQ(blockCount, blocks.size());
+
+    bool currentVersionBlock = false;
+    bool newerVersionBlock = false;
+    for (const VpBlockProperties& block : blocks) {
+        EXPECT_STREQ(block.profiles.profileName, VP_ANDROID_BASELINE_2021_NAME);
+        currentVersionBlock |= block.profiles.specVersion == VP_ANDROID_BASELINE_2021_SPEC_VERSION;
+        newerVersionBlock |= block.profiles.specVersion == VP_ANDROID_BASELINE_2021_SPEC_VERSION + 1;
+    }
+    EXPECT_TRUE(currentVersionBlock);
+    EXPECT_TRUE(newerVersionBlock);
+
+    uint32_t incompleteCount = 1;
+    VpBlockProperties incompleteBlock{};
+    result = vpGetPhysicalDeviceProfilesSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, 2, profiles, supported, &incompleteCount, &incompleteBlock);
+    EXPECT_EQ(result, VK_INCOMPLETE);
+    EXPECT_EQ(incompleteCount, 1);
+    EXPECT_STREQ(incompleteBlock.profiles.profileName, blocks[0].profiles.profileName);
+    EXPECT_EQ(incompleteBlock.profiles.specVersion, blocks[0].profiles.specVersion);
+}
+
+TEST(mocked_api_get_physdev_profile_support, vulkan10_ranking) {
+    MockVulkanAPI mock;
+
+#ifdef WITH_DEBUG_MESSAGES
+    // Each ranking checks both profiles on both physical devices, possibly on different threads. The blocks of the newer
+    // profile version are checked too.
+    const char* unsupportedExtension = "Unsupported extension: VK_GOOGLE_display_timing";
+    const char* unsupportedVersion = "Unsupported requested VP_ANDROID_baseline_2021 profile version: 4, profile supported at version 3";
+    MockDebugMessageCallback cb({
+        unsupportedExtension, unsupportedVersion, unsupportedExtension, unsupportedVersion,
+        unsupportedExtension, unsupportedVersion, unsupportedExtension, unsupportedVersion,
+        unsupportedExtension, unsupportedVersion, unsupportedExtension, unsupportedVersion
+    }, false);
+#endif
+
+    AndroidBaseline2021Device device(mock);
+
+    // The first enumerated physical device doesn't support the profile, the second one does
+    const VkPhysicalDevice supportedPhysicalDevice = VkPhysicalDevice(0x43D00D00);
+    mock.AddPhysicalDevice(supportedPhysicalDevice);
+    mock.SetDeviceExtensions(supportedPhysicalDevice, device.extensions);
+    device.RemoveExtension(mock.vkPhysicalDevice, VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+
+    // The second profile requests a newer version of the profile than the library supports
+    const VpProfileProperties profiles[] = {
+        device.profile,
+        { VP_ANDROID_BASELINE_2021_NAME, VP_ANDROID_BASELINE_2021_SPEC_VERSION + 1 }
+    };
+
+    uint32_t rankingCount = 0;
+    VkResult result = vpGetPhysicalDeviceRankings(mock.functions, mock.vkInstance, 2, profiles, 0, &rankingCount, nullptr);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(rankingCount, 2);
+
+    // The physical devices are sorted by their preferred supported profile, whether they are checked serially or in parallel
+    const VpPhysicalDeviceRankingFlags flags[] = { 0, VP_PHYSICAL_DEVICE_RANKING_PARALLEL_BIT };
+    for (VpPhysicalDeviceRankingFlags flag : flags) {
+        VpPhysicalDeviceRanking rankings[2]{};
+        rankingCount = 2;
+        result = vpGetPhysicalDeviceRankings(mock.functions, mock.vkInstance, 2, profiles, flag, &rankingCount, rankings);
+        EXPECT_EQ(result, VK_SUCCESS);
+        EXPECT_EQ(rankingCount, 2);
+        EXPECT_EQ(rankings[0].physicalDevice, supportedPhysicalDevice);
+        EXPECT_EQ(rankings[0].firstSupportedProfileIndex, 0);
+        EXPECT_EQ(rankings[0].supportedProfileCount, 1);
+        EXPECT_EQ(rankings[1].physicalDevice, mock.vkPhysicalDevice);
+        EXPECT_EQ(rankings[1].firstSupportedProfileIndex, 2);
+        EXPECT_EQ(rankings[1].supportedProfileCount, 0);
+    }
+
+    // Only the best physical device is returned
+    VpPhysicalDeviceRanking ranking{};
+    rankingCount = 1;
+    result = vpGetPhysicalDeviceRankings(mock.functions, mock.vkInstance, 2, profiles, VP_PHYSICAL_DEVICE_RANKING_PARALLEL_BIT, &rankingCount, &ranking);
+    EXPECT_EQ(result, VK_INCOMPLETE);
+    EXPECT_EQ(rankingCount, 1);
+    EXPECT_EQ(ranking.physicalDevice, supportedPhysicalDevice);
+}
+
+TEST(mocked_api_get_physdev_profile_support, vulkan10_snapshot) {
+    MockVulkanAPI mock;
+
+#ifdef WITH_DEBUG_MESSAGES
+    MockDebugMessageCallback cb({
+        "Unsupported feature condition: VkPhysicalDeviceFeatures2KHR::features.sampleRateShading == VK_TRUE"
+    });
+#endif
+
+    AndroidBaseline2021Device device(mock);
+    const VpProfileProperties& profile = device.profile;
+
+    VpPhysicalDeviceSnapshot snapshot = VK_NULL_HANDLE;
+    VkResult result = vpCreatePhysicalDeviceSnapshot(mock.functions, mock.vkPhysicalDevice, &snapshot);
+    EXPECT_EQ(result, VK_SUCCESS);
+
+    VkBool32 supported = VK_FALSE;
+    result = vpGetPhysicalDeviceProfileSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, &profile, &supported);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(supported, VK_TRUE);
+
+    // The features were captured by the first query, the driver is no longer called until the snapshot is invalidated
+    device.features.features.sampleRateShading = VK_FALSE;
+    device.SetFeatures();
+
+    supported = VK_FALSE;
+    result = vpGetPhysicalDeviceProfileSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, &profile, &supported);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(supported, VK_TRUE);
+
+    vpInvalidatePhysicalDeviceSnapshot(snapshot);
+
+    supported = VK_TRUE;
+    result = vpGetPhysicalDeviceProfileSupport(mock.functions, mock.vkInstance, mock.vkPhysicalDevice, &profile, &supported);
+    EXPECT_EQ(result, VK_SUCCESS);
+    EXPECT_EQ(supported, VK_FALSE);
+
+    vpDestroyPhysicalDeviceSnapshot(snapshot);
+}
+
 // Vulkan 1.1 is required
 TEST(DISABLED_mocked_api_get_physdev_profile_support, vulkan10_no_gpdp2) {
     MockVulkanAPI mock;
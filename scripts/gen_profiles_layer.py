@@ -81,14 +81,44 @@ INCLUDES_HEADER = '''
 #include <algorithm>
 #include <filesystem>
 #include <functional>
+#include <map>
+#include <tuple>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <optional>
+#include <string_view>
+#include <thread>
 
 namespace fs = std::filesystem;
 '''
 
+STRING_TABLE_FUNCTIONS = '''
+// Perfect hash tables generated from the Vulkan registry, looking up a string costs two hashes and one comparison
+
+template <typename T>
+struct StringTableEntry {
+    std::string_view name;
+    T value;
+};
+
+// FNV-1a, the seed selects one of the hash functions. Must match hash_string in gen_profiles_layer.py
+static constexpr uint32_t HashString(std::string_view string, uint32_t seed) {
+    uint32_t hash = (2166136261u ^ seed) * 16777619u;
+    for (const char c : string) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T, std::size_t B, std::size_t N>
+static constexpr const T *FindStringTableEntry(const uint32_t (&seeds)[B], const StringTableEntry<T> (&entries)[N], std::string_view name) {
+    const StringTableEntry<T> &entry = entries[HashString(name, seeds[HashString(name, 0) % B]) % N];
+    return (!entry.name.empty() && entry.name == name) ? &entry.value : nullptr;
+}
+'''
+
 GLOBAL_CONSTANTS = '''
 // Global constants //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -124,51 +154,144 @@ const std::array<VkExtensionProperties, 2> kDeviceExtensionProperties = {
     {{VK_EXT_TOOLING_INFO_EXTENSION_NAME, VK_EXT_TOOLING_INFO_SPEC_VERSION},
      {VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME, VK_KHR_PORTABILITY_SUBSET_SPEC_VERSION}}};
 const uint32_t kDeviceExtensionPropertiesCount = static_cast<uint32_t>(kDeviceExtensionProperties.size());
+
+// Upper bound of the threads reading the profile files when loading the profiles database
+const std::size_t kMaxProfileLoadThreads = 8;
+
+// Size of the beginning of a JSON file read to find its $schema member before parsing the whole file
+const std::size_t kProfileProbeSize = 4096;
+
+// Compressed format families supported by a physical device
+enum TextureCompressionBits {
+    TEXTURE_COMPRESSION_ASTC_LDR_BIT = (1 << 0),
+    TEXTURE_COMPRESSION_ASTC_HDR_BIT = (1 << 1),
+    TEXTURE_COMPRESSION_ETC2_BIT = (1 << 2),
+    TEXTURE_COMPRESSION_BC_BIT = (1 << 3),
+    TEXTURE_COMPRESSION_PVRTC_BIT = (1 << 4),
+};
+typedef uint32_t TextureCompressionFlags;
 '''
 
 GLOBAL_VARS = '''
 // Global variables //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 uint32_t requested_version = 0;
-bool device_has_astc_hdr = false;
-bool device_has_astc = false;
-bool device_has_etc2 = false;
-bool device_has_bc = false;
-bool device_has_pvrtc = false;
 
-std::recursive_mutex global_lock;  // Enforce thread-safety for this layer.
+// Guards the instance level tables: dispatch tables, JsonLoader and PhysicalDeviceData maps. Taken exclusively only when
+// instances and physical devices are created or destroyed. Queries on populated physical devices go through the published
+// PhysicalDeviceData snapshot and don't take it at all.
+std::shared_mutex instance_lock;
 '''
 
 PHYSICAL_DEVICE_DATA_BEGIN = '''
+// Image format properties query without pNext chain, memoized when image_format_cache_size is set
+struct ImageFormatQuery {
+    VkFormat format;
+    VkImageType type;
+    VkImageTiling tiling;
+    VkImageUsageFlags usage;
+    VkImageCreateFlags flags;
+
+    bool operator==(const ImageFormatQuery &other) const {
+        return format == other.format && type == other.type && tiling == other.tiling && usage == other.usage &&
+               flags == other.flags;
+    }
+
+    struct hash {
+        std::size_t operator()(const ImageFormatQuery &key) const {
+            const std::size_t kMagic = 0x9e3779b97f4a7c16UL;
+            std::size_t h = 0;
+            h ^= std::hash<decltype(key.format)>{}(key.format) + kMagic + (h << 6) + (h >> 2);
+            h ^= std::hash<decltype(key.type)>{}(key.type) + kMagic + (h << 6) + (h >> 2);
+            h ^= std::hash<decltype(key.tiling)>{}(key.tiling) + kMagic + (h << 6) + (h >> 2);
+            h ^= std::hash<decltype(key.usage)>{}(key.usage) + kMagic + (h << 6) + (h >> 2);
+            h ^= std::hash<decltype(key.flags)>{}(key.flags) + kMagic + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+};
+
+struct ImageFormatAnswer {
+    VkImageFormatProperties properties;
+    VkResult result;
+};
+
+// Emulated structure copied into the pNext chains of the features and properties queries
+struct PNextFillEntry {
+    const void *data;
+    std::size_t size;
+};
+
 // PhysicalDeviceData : creates and manages the simulated device configurations //////////////////////////////////////////////////
 
 class PhysicalDeviceData {
    public:
-    // Create a new PDD element during vkCreateInstance(), and preserve in map, indexed by physical_device.
-    static PhysicalDeviceData &Create(VkPhysicalDevice pd, VkInstance instance) {
+    // Create a new PDD element during vkEnumeratePhysicalDevices(), and preserve in map, indexed by physical_device.
+    // The PDD is not visible to Find() until the next Publish().
+    static PhysicalDeviceData &Create(VkPhysicalDevice pd, VkInstance instance, ProfileLayerSettings *layer_settings) {
         assert(pd != VK_NULL_HANDLE);
         assert(instance != VK_NULL_HANDLE);
-        assert(!Find(pd));  // Verify this instance does not already exist.
+        assert(map().find(pd) == map().end());  // Verify this instance does not already exist.
 
-        const auto result = map().emplace(pd, instance);
+        const auto result = map().emplace(pd, std::make_unique<PhysicalDeviceData>(instance));
         assert(result.second);  // true=insertion, false=replacement
         auto iter = result.first;
-        PhysicalDeviceData *pdd = &iter->second;
-        assert(Find(pd) == pdd);  // Verify we get the same instance we just inserted.
+        PhysicalDeviceData *pdd = iter->second.get();
+        pdd->physical_device_ = pd;
+        pdd->dispatch_table_ = instance_dispatch_table(instance);
+        pdd->layer_settings_ = layer_settings;
         return *pdd;
     }
 
+    // Queries on a physical device must not race the destruction of its instance, so the PDD is released right away even if
+    // the current snapshot still refers to it until the next Publish().
     static void Destroy(const VkPhysicalDevice pd) {
+        const auto iter = map().find(pd);
+        if (iter != map().end() && iter->second->layer_settings_->simulate.image_format_cache_size > 0) {
+            const PhysicalDeviceData &pdd = *iter->second;
+            std::shared_lock<std::shared_mutex> lock(pdd.image_format_cache_mutex_);
+            LogMessage(pdd.layer_settings_, DEBUG_REPORT_NOTIFICATION_BIT,
+                       "Image format cache of \\"%s\\": %" PRIu64 " hits, %" PRIu64 " misses, %zu entries.\\n",
+                       pdd.physical_device_properties_.deviceName, pdd.image_format_cache_hits_.load(std::memory_order_relaxed),
+                       pdd.image_format_cache_misses_, pdd.image_format_cache_.size());
+        }
         map().erase(pd);
     }
 
-    // Find a PDD from our map, or nullptr if doesn't exist.
-    static PhysicalDeviceData *Find(VkPhysicalDevice pd) {
-        const auto iter = map().find(pd);
-        return (iter != map().end()) ? &iter->second : nullptr;
+    // Freeze the fully populated PDDs into a new immutable snapshot and make it visible to Find().
+    // Must be called with instance_lock held exclusively.
+    static void Publish() {
+        auto next = std::make_shared<Snapshot>();
+        next->reserve(map().size());
+        for (const auto &entry : map()) {
+            next->emplace(entry.first, entry.second.get());
+        }
+
+        // The previous snapshot is released when the last lookup still reading it returns
+        std::atomic_store_explicit(&snapshot(), std::shared_ptr<const Snapshot>(std::move(next)), std::memory_order_release);
+    }
+
+    // Lookup of a published PDD, or nullptr if the physical device was not populated by the layer. No lock is taken: the
+    // snapshot is only held for the lookup, the returned PDD lives as long as the instance of the physical device.
+    static const PhysicalDeviceData *Find(VkPhysicalDevice pd) {
+        const std::shared_ptr<const Snapshot> current = std::atomic_load_explicit(&snapshot(), std::memory_order_acquire);
+        if (current == nullptr) {
+            return nullptr;
+        }
+        const auto iter = current->find(pd);
+        return (iter != current->end()) ? iter->second : nullptr;
+    }
+
+    // Queries on a physical device without published PDD are forwarded to the next layer and need the instance tables.
+    static std::shared_lock<std::shared_mutex> LockIfUnpublished(const PhysicalDeviceData *pdd) {
+        return pdd == nullptr ? std::shared_lock<std::shared_mutex>(instance_lock) : std::shared_lock<std::shared_mutex>();
+    }
+
+    static VkuInstanceDispatchTable *DispatchTable(const PhysicalDeviceData *pdd, VkPhysicalDevice pd) {
+        return pdd != nullptr ? pdd->dispatch_table_ : instance_dispatch_table(pd);
     }
 
-    static bool HasExtension(PhysicalDeviceData *pdd, const char *extension_name) {
+    static bool HasExtension(const PhysicalDeviceData *pdd, const char *extension_name) {
         return pdd->device_extensions_.count(extension_name) > 0;
     }
 
@@ -176,7 +299,7 @@ class PhysicalDeviceData {
         return HasSimulatedExtension(Find(pd), extension_name);
     }
 
-    static bool HasSimulatedExtension(PhysicalDeviceData *pdd, const char *extension_name) {
+    static bool HasSimulatedExtension(const PhysicalDeviceData *pdd, const char *extension_name) {
         return pdd->simulation_extensions_.count(extension_name) > 0;
     }
 
@@ -184,23 +307,86 @@ class PhysicalDeviceData {
         return HasSimulatedOrRealExtension(Find(pd), extension_name);
     }
 
-    static bool HasSimulatedOrRealExtension(PhysicalDeviceData *pdd, const char *extension_name) {
+    static bool HasSimulatedOrRealExtension(const PhysicalDeviceData *pdd, const char *extension_name) {
         return HasSimulatedExtension(pdd, extension_name) || HasExtension(pdd, extension_name);
     }
 
-    uint32_t GetEffectiveVersion() {
+    uint32_t GetEffectiveVersion() const {
         return requested_version < physical_device_properties_.apiVersion ? requested_version
                                                                           : physical_device_properties_.apiVersion;
 
     }
 
+    // The profile may override physical_device_properties_.apiVersion while the PDD is populated, the calls down to the
+    // driver must use the version of the driver instead.
+    uint32_t GetDeviceEffectiveVersion() const {
+        return requested_version < device_api_version_ ? requested_version : device_api_version_;
+    }
+
     VkInstance instance() const { return instance_; }
+    VkPhysicalDevice physical_device() const { return physical_device_; }
+    ProfileLayerSettings *layer_settings() const { return layer_settings_; }
+
+    // Device format properties are only needed to check the formats referenced by the profiles, so they are queried from
+    // the driver the first time a profile format is loaded instead of sweeping every VkFormat at enumeration.
+    void LoadDeviceFormat(VkFormat format) {
+        if (device_formats_.count(format) > 0) {
+            return;
+        }
+
+        VkFormatProperties3KHR format_properties_3 = {};
+        format_properties_3.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3_KHR;
+
+        VkFormatProperties2 format_properties = {};
+        format_properties.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;
+        format_properties.pNext = &format_properties_3;
+
+        if (GetDeviceEffectiveVersion() >= VK_API_VERSION_1_1) {
+            dispatch_table_->GetPhysicalDeviceFormatProperties2(physical_device_, format, &format_properties);
+        } else {
+            dispatch_table_->GetPhysicalDeviceFormatProperties2KHR(physical_device_, format, &format_properties);
+        }
+        device_formats_[format] = format_properties.formatProperties;
+        device_formats_3_[format] = format_properties_3;
+    }
+
+    // Image format queries are memoized on the published PDD, the only state modified after Publish(). The hits only
+    // take the lock shared, so they run concurrently.
+    bool FindImageFormatProperties(const ImageFormatQuery &query, ImageFormatAnswer *answer) const {
+        std::shared_lock<std::shared_mutex> lock(image_format_cache_mutex_);
+        const auto iter = image_format_cache_.find(query);
+        if (iter == image_format_cache_.end()) {
+            return false;
+        }
+        image_format_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        *answer = iter->second;
+        return true;
+    }
 
+    // Record the driver answer of a query missing from the cache
+    void StoreImageFormatProperties(const ImageFormatQuery &query, const ImageFormatAnswer &answer) const {
+        std::unique_lock<std::shared_mutex> lock(image_format_cache_mutex_);
+        ++image_format_cache_misses_;
+        // When the cache is full, the first answers are kept and the new queries keep calling down to the driver
+        const bool cacheable = answer.result == VK_SUCCESS || answer.result == VK_ERROR_FORMAT_NOT_SUPPORTED;
+        if (cacheable && image_format_cache_.size() < layer_settings_->simulate.image_format_cache_size) {
+            image_format_cache_.emplace(query, answer);
+        }
+    }
+
+    uint32_t device_api_version_{0};
     MapOfVkExtensionProperties device_extensions_{};
     MapOfVkFormatProperties device_formats_{};
     MapOfVkFormatProperties3 device_formats_3_{};
     ArrayOfVkQueueFamilyProperties device_queue_family_properties_{};
     SetOfVideoProfiles set_of_device_video_profiles_{};
+    bool device_video_profiles_loaded_{false};
+    TextureCompressionFlags device_texture_compression_{0};
+    std::unordered_set<VkFormat> excluded_formats_{};
+
+    // Built by BuildPNextFillPlan once the PDD is populated, only the structures the device exposes are in the plan
+    std::unordered_map<VkStructureType, PNextFillEntry> pnext_fill_plan_{};
+    VkPhysicalDevicePortabilitySubsetPropertiesKHR emulated_portability_subset_properties_{};
     MapOfVkExtensionProperties simulation_extensions_{};
     VkPhysicalDeviceProperties physical_device_properties_{};
     VkPhysicalDeviceFeatures physical_device_features_{};
@@ -254,12 +440,28 @@ PHYSICAL_DEVICE_DATA_END = '''    }
   private:
 
     const VkInstance instance_;
+    VkPhysicalDevice physical_device_{VK_NULL_HANDLE};
+    VkuInstanceDispatchTable *dispatch_table_{nullptr};
+    ProfileLayerSettings *layer_settings_{nullptr};
+
+    mutable std::shared_mutex image_format_cache_mutex_;
+    mutable std::unordered_map<ImageFormatQuery, ImageFormatAnswer, ImageFormatQuery::hash> image_format_cache_;
+    // The hits are counted under the shared lock, the misses under the exclusive lock
+    mutable std::atomic<uint64_t> image_format_cache_hits_{0};
+    mutable uint64_t image_format_cache_misses_{0};
 
-    typedef std::unordered_map<VkPhysicalDevice, PhysicalDeviceData> Map;
+    typedef std::unordered_map<VkPhysicalDevice, std::unique_ptr<PhysicalDeviceData>> Map;
     static Map& map() {
         static Map map_;
         return map_;
     }
+
+    // Only replaced by Publish(), which instance_lock serializes, and read by Find() without lock
+    typedef std::unordered_map<VkPhysicalDevice, const PhysicalDeviceData *> Snapshot;
+    static std::shared_ptr<const Snapshot>& snapshot() {
+        static std::shared_ptr<const Snapshot> snapshot_;
+        return snapshot_;
+    }
 };
 
 '''
@@ -306,11 +508,13 @@ class JsonLoader {
     void LogFoundProfiles();
     const Json::Value& FindRootFromProfileName(const std::string& profile_name) const;
     VkResult LoadProfilesDatabase();
-    VkResult LoadFile(const std::string& filename);
     void ReadProfileApiVersion();
+    void CompileExclusions();
     VkResult LoadDevice(const char* device_name, PhysicalDeviceData *pdd);
     VkResult ReadProfile(const char* device_name, const Json::Value& root, const std::vector<std::vector<std::string>> &capabilities, bool requested_profile, bool enable_warnings);
     uint32_t GetProfileApiVersion() const { return profile_api_version_; }
+    const std::unordered_set<std::string> &GetExcludedExtensions() const { return excluded_extensions_; }
+    const std::unordered_set<VkFormat> &GetExcludedFormats() const { return excluded_formats_; }
     void CollectProfiles(const std::string& profile_name, std::vector<std::string>& results) const;
 
     ProfileLayerSettings layer_settings;
@@ -319,10 +523,33 @@ class JsonLoader {
     PhysicalDeviceData *pdd_;
 
     std::map<std::string, Json::Value> profiles_file_roots_;
+    JsonProfileCache profile_cache_;
+
+    // Profile file read by a worker thread of LoadProfilesDatabase, then added to the database in the order of the files
+    struct ProfileFile {
+        std::string filename;
+        Json::Value root{Json::nullValue};
+        JsonProfileCache::EntryType cache_type{JsonProfileCache::ENTRY_PROFILE};
+        bool cached{false};
+        std::string error{};
+
+        enum Validation {
+            VALIDATION_SKIPPED,
+            VALIDATION_NO_SCHEMA,
+            VALIDATION_FAILED,
+            VALIDATION_PASSED,
+        };
+        Validation validation{VALIDATION_SKIPPED};
+    };
+
+    void ReadFile(ProfileFile& file) const;
+    void ValidateFile(ProfileFile& file) const;
+    void ReadFiles(std::vector<ProfileFile>& files) const;
+    VkResult AddFile(ProfileFile& file);
 
     std::uint32_t profile_api_version_;
-    std::vector<std::string> excluded_extensions_;
-    std::vector<std::string> excluded_formats_;
+    std::unordered_set<std::string> excluded_extensions_;
+    std::unordered_set<VkFormat> excluded_formats_;
 
     struct Extension {
         std::string name;
@@ -609,7 +836,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (!value.isDouble()) {
             return true;
         }
@@ -637,7 +864,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         bool valid = true;
         if (value.isBool()) {
             const bool new_value = value.asBool();
@@ -681,7 +908,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (!value.isInt()) {
             return true;
         }
@@ -709,7 +936,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (!value.isInt64()) {
             return true;
         }
@@ -737,7 +964,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         bool valid = true;
         if (value.isBool()) {
             const bool new_value = value.asBool();
@@ -786,7 +1013,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (!value.isUInt64()) {
             return true;
         }
@@ -814,7 +1041,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value parent = pparent[name];
+        const Json::Value &parent = pparent[name];
         if (parent.type() != Json::objectValue) {
             return true;
         }
@@ -836,7 +1063,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value parent = pparent[name];
+        const Json::Value &parent = pparent[name];
         if (parent.type() != Json::objectValue) {
             return true;
         }
@@ -859,7 +1086,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         bool valid = true;
         if (value.isUInt()) {
             const size_t new_value = value.asUInt();
@@ -887,7 +1114,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         bool valid = true;
         uint64_t new_value = 0;
         if (value.isArray()) {
@@ -918,7 +1145,7 @@ GET_VALUE_FUNCTIONS = '''
             return true;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         bool valid = true;
         uint32_t new_value = 0;
         if (value.isString()) {
@@ -947,7 +1174,7 @@ GET_VALUE_FUNCTIONS = '''
             return -1;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (value.type() != Json::arrayValue) {
             return -1;
         }
@@ -967,7 +1194,7 @@ GET_VALUE_FUNCTIONS = '''
             return -1;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (value.type() != Json::arrayValue) {
             return -1;
         }
@@ -987,7 +1214,7 @@ GET_VALUE_FUNCTIONS = '''
             return -1;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (value.type() != Json::arrayValue) {
             return -1;
         }
@@ -1007,7 +1234,7 @@ GET_VALUE_FUNCTIONS = '''
             return -1;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (!value.isString()) {
             return -1;
         }
@@ -1030,7 +1257,7 @@ GET_VALUE_FUNCTIONS = '''
             return -1;
         }
 
-        const Json::Value value = parent[name];
+        const Json::Value &value = parent[name];
         if (value.type() != Json::arrayValue) {
             return -1;
         }
@@ -1101,29 +1328,32 @@ bool JsonLoader::GetFormat(const char *device_name, bool requested_profile, cons
     (*dest)[format] = profile_properties;
     (*dest3)[format] = profile_properties_3;
 
-    if (IsASTCHDRFormat(format) && !device_has_astc_hdr) {
+    const TextureCompressionFlags texture_compression = pdd_->device_texture_compression_;
+    if (IsASTCHDRFormat(format) && !(texture_compression & TEXTURE_COMPRESSION_ASTC_HDR_BIT)) {
         // We already notified that ASTC HDR is not supported, no spamming
         return false;
     }
-    if (IsASTCLDRFormat(format) && !device_has_astc) {
+    if (IsASTCLDRFormat(format) && !(texture_compression & TEXTURE_COMPRESSION_ASTC_LDR_BIT)) {
         // We already notified that ASTC is not supported, no spamming
         return false;
     }
-    if ((IsETC2Format(format) || IsEACFormat(format)) && !device_has_etc2) {
+    if ((IsETC2Format(format) || IsEACFormat(format)) && !(texture_compression & TEXTURE_COMPRESSION_ETC2_BIT)) {
         // We already notified that ETC2 is not supported, no spamming
         return false;
     }
-    if (IsBCFormat(format) && !device_has_bc) {
+    if (IsBCFormat(format) && !(texture_compression & TEXTURE_COMPRESSION_BC_BIT)) {
         // We already notified that BC is not supported, no spamming
         return false;
     }
-    if (IsPVRTCFormat(format) &&!device_has_pvrtc) {
+    if (IsPVRTCFormat(format) && !(texture_compression & TEXTURE_COMPRESSION_PVRTC_BIT)) {
         // We already notified that PVRTC is not supported, no spamming
         return false;
     }
 
     bool valid = true;
 
+    pdd_->LoadDeviceFormat(format);
+
     const VkFormatProperties &device_properties = pdd_->device_formats_[format];
     if (!HasFlags(device_properties.linearTilingFeatures, profile_properties.linearTilingFeatures)) {
         WarnMissingFormatFeatures(&layer_settings, device_name, format_name, "linearTilingFeatures", profile_properties.linearTilingFeatures,
@@ -1163,23 +1393,23 @@ bool JsonLoader::GetFormat(const char *device_name, bool requested_profile, cons
 
 bool JsonLoader::CheckVersionSupport(uint32_t version, const std::string &name) {
     if (pdd_->GetEffectiveVersion() < version) {
-        LogMessage(&layer_settings,
-            DEBUG_REPORT_ERROR_BIT,
-            "Profile sets %s which is provided by Vulkan version %s, but the current effective API version is %s.\\n",
-                     name.c_str(), StringAPIVersion(version).c_str(), StringAPIVersion(pdd_->GetEffectiveVersion()).c_str());
+        if (IsLogEnabled(&layer_settings, DEBUG_REPORT_ERROR_BIT)) {
+            LogMessage(&layer_settings,
+                DEBUG_REPORT_ERROR_BIT,
+                "Profile sets %s which is provided by Vulkan version %s, but the current effective API version is %s.\\n",
+                         name.c_str(), StringAPIVersion(version).c_str(), StringAPIVersion(pdd_->GetEffectiveVersion()).c_str());
+        }
         return false;
     }
     return true;
 }
 
 JsonLoader::ExtensionSupport JsonLoader::CheckExtensionSupport(const char *extension, const std::string &name) {
-    for (const auto &ext : excluded_extensions_) {
-        if (ext == extension) {
-            LogMessage(&layer_settings, DEBUG_REPORT_NOTIFICATION_BIT,
-                       "Profile requires %s capabilities, but %s is excluded, device values are used.\\n", name.c_str(),
-                                extension);
-            return JsonLoader::ExtensionSupport::EXCLUDED;
-        }
+    if (excluded_extensions_.count(extension) > 0) {
+        LogMessage(&layer_settings, DEBUG_REPORT_NOTIFICATION_BIT,
+                   "Profile requires %s capabilities, but %s is excluded, device values are used.\\n", name.c_str(),
+                            extension);
+        return JsonLoader::ExtensionSupport::EXCLUDED;
     }
     if (layer_settings.simulate.capabilities & SIMULATE_EXTENSIONS_BIT) {
         if (!PhysicalDeviceData::HasSimulatedExtension(pdd_, extension)) {
@@ -1321,6 +1551,10 @@ bool JsonLoader::GetQueueFamilyProperties(const char* device_name, const Json::V
         supported = true;
         break;
     }
+    // The description of the queue family is only built when the warning is reported
+    if (!supported && !IsLogEnabled(&layer_settings, DEBUG_REPORT_WARNING_BIT)) {
+        return false;
+    }
     if (!supported) {
         std::string message =
             format("Device (%s) has no queue family that supports VkQueueFamilyProperties [queueFlags: %s, queueCount: %" PRIu32
@@ -1373,7 +1607,7 @@ bool JsonLoader::GetQueueFamilyProperties(const char* device_name, const Json::V
             message += format(", VkQueueFamilyQueryResultStatusPropertiesKHR [queryResultStatusSupport: VK_TRUE]");
         }
         message += ".\\n";
-        LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT, message.c_str());
+        LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT, "%s", message.c_str());
         valid = false;
     }
 
@@ -1473,48 +1707,51 @@ bool JsonLoader::OrderQueueFamilyProperties(ArrayOfVkQueueFamilyProperties *qfp)
     if (pdd_->device_queue_family_properties_.size() < qfp->size()) {
         return false;
     }
-    // Find all permutations and see if any of them supports profile queue families
-    std::vector<uint32_t> permutations(pdd_->device_queue_family_properties_.size());
-    uint32_t count = static_cast<uint32_t>(permutations.size());
-    for (uint32_t i = 0; i < count; ++i) {
-        permutations[i] = i;
+
+    const std::size_t device_count = pdd_->device_queue_family_properties_.size();
+    const std::size_t profile_count = qfp->size();
+
+    std::vector<std::vector<bool>> compatible(device_count, std::vector<bool>(profile_count));
+    for (std::size_t device = 0; device < device_count; ++device) {
+        for (std::size_t profile = 0; profile < profile_count; ++profile) {
+            compatible[device][profile] = QueueFamilyAndExtensionsMatch(pdd_->device_queue_family_properties_[device], (*qfp)[profile]);
+        }
     }
-    do {
-        bool match = true;
-        for (uint32_t i = 0; i < count; ++i) {
-            if (permutations[i] < qfp->size() &&
-                !QueueFamilyAndExtensionsMatch(pdd_->device_queue_family_properties_[i], (*qfp)[permutations[i]])) {
-                match = false;
-                break;
-            }
+
+    std::vector<std::size_t> assignment;
+    if (!MatchQueueFamilies(compatible, profile_count, &assignment)) {
+        LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT,
+                   "Device supports all individual profile queue families, but not all of them simultaneously.\\n");
+        return false;
+    }
+
+    // Empty queue families at the end are not needed
+    uint32_t count = 0;
+    for (std::size_t device = 0; device < device_count; ++device) {
+        if (assignment[device] != SIZE_MAX) {
+            count = static_cast<uint32_t>(device + 1);
         }
-        if (match) {
-            // Empty queue families at the end are not needed
-            while (permutations[count - 1] >= qfp->size()) {
-                --count;
-            }
-            ArrayOfVkQueueFamilyProperties ordered;
-            for (uint32_t i = 0; i < count; ++i) {
-                if (permutations[i] < qfp->size()) {
-                    ordered.push_back((*qfp)[permutations[i]]);
-                } else {
-                    ordered.push_back(QueueFamilyProperties());
-                }
-            }
-            *qfp = ordered;
-            for (uint32_t i = 0; i < count; ++i) {
-                CopyUnsetQueueFamilyProperties(&pdd_->device_queue_family_properties_[i], &(*qfp)[i]);
-            }
-            return true;
+    }
+
+    ArrayOfVkQueueFamilyProperties ordered;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (assignment[i] != SIZE_MAX) {
+            ordered.push_back((*qfp)[assignment[i]]);
+        } else {
+            ordered.push_back(QueueFamilyProperties());
         }
-    } while (std::next_permutation(permutations.begin(), permutations.end()));
-    LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT,
-               "Device supports all individual profile queue families, but not all of them simultaneously.\\n");
-    return false;
+    }
+    *qfp = ordered;
+    for (uint32_t i = 0; i < count; ++i) {
+        CopyUnsetQueueFamilyProperties(&pdd_->device_queue_family_properties_[i], &(*qfp)[i]);
+    }
+    return true;
 }
 '''
 
 READ_PROFILE = '''
+static void LoadVideoProfiles(VkInstance instance, VkPhysicalDevice pd, PhysicalDeviceData *pdd, SimulateCapabilityFlags flags);
+
 VkResult JsonLoader::ReadProfile(const char *device_name, const Json::Value& root, const std::vector<std::vector<std::string>> &capabilities, bool requested_profile, bool enable_warnings) {
     bool failed = false;
 
@@ -1728,6 +1965,9 @@ VkResult JsonLoader::ReadProfile(const char *device_name, const Json::Value& roo
         }
 
         if (!parsed_video_profiles.empty()) {
+            // The device video profiles are only probed when a profile actually defines video profiles
+            LoadVideoProfiles(pdd_->instance(), pdd_->physical_device(), pdd_, layer_settings.simulate.capabilities);
+
             auto for_each_matching_video_profile = [&](const VideoProfileInfoChain &video_profile_info,
                                                     std::function<void(const JsonVideoProfileData&)> callback) {
                 for (const auto &parsed_video_profile : parsed_video_profiles) {
@@ -1883,9 +2123,11 @@ VkResult JsonLoader::ReadProfile(const char *device_name, const Json::Value& roo
                                 VideoFormatPropertiesChain format(info.videoCodecOperation, usage, check_api_version, check_extension);
                                 if (json_video_format.IsComplete(format)) {
                                     json_video_format.CopyTo(format);
-                                    LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT,
-                                               "Simulating video format %s for video profile '%s' that is not supported by the device\\n",
-                                               vkFormatToString(format.video_format_properties_.format).c_str(), name);
+                                    if (IsLogEnabled(&layer_settings, DEBUG_REPORT_WARNING_BIT)) {
+                                        LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT,
+                                                   "Simulating video format %s for video profile '%s' that is not supported by the device\\n",
+                                                   vkFormatToString(format.video_format_properties_.format).c_str(), name);
+                                    }
                                     formats.push_back(format);
                                 }
                             }
@@ -1899,9 +2141,11 @@ VkResult JsonLoader::ReadProfile(const char *device_name, const Json::Value& roo
                                     json_video_format.IsMatching(format)) {
                                     bool success = merged_props.Combine(&layer_settings, json_video_format);
                                     if (!success) {
-                                        LogMessage(&layer_settings, DEBUG_REPORT_ERROR_BIT,
-                                                   "Failed to merge video format %s data for video profile '%s'\\n",
-                                                   vkFormatToString(format.video_format_properties_.format).c_str(), name);
+                                        if (IsLogEnabled(&layer_settings, DEBUG_REPORT_ERROR_BIT)) {
+                                            LogMessage(&layer_settings, DEBUG_REPORT_ERROR_BIT,
+                                                       "Failed to merge video format %s data for video profile '%s'\\n",
+                                                       vkFormatToString(format.video_format_properties_.format).c_str(), name);
+                                        }
                                         failed = true;
                                     }
                                 }
@@ -1982,81 +2226,185 @@ VkResult JsonLoader::ReadProfile(const char *device_name, const Json::Value& roo
     return VK_SUCCESS;
 }
 
-VkResult JsonLoader::LoadFile(const std::string& filename) {
-    if (filename.empty()) {
-        return VK_SUCCESS;
+void JsonLoader::ReadFile(ProfileFile& file) const {
+    if (!layer_settings.simulate.profile_cache.empty() && profile_cache_.Find(file.filename, &file.cache_type, &file.root)) {
+        file.cached = true;
+        if (file.cache_type == JsonProfileCache::ENTRY_PROFILE && layer_settings.simulate.profile_validation) {
+            ValidateFile(file);
+        }
+        return;
     }
-    std::ifstream json_file(filename);
+
+    std::ifstream json_file(file.filename, std::ios::binary);
     if (!json_file) {
-        LogMessage(&layer_settings, DEBUG_REPORT_ERROR_BIT, "Fail to open file \\"%s\\"\\n", filename.c_str());
-        return VK_SUCCESS;
+        file.error = format("Fail to open file \\"%s\\"\\n", file.filename.c_str());
+        return;
+    }
+
+    // Only read the beginning of the file to check the $schema member, most JSON files that are not profiles are rejected
+    // without reading and parsing the whole file
+    std::string content(kProfileProbeSize, '\\0');
+    json_file.read(&content[0], static_cast<std::streamsize>(content.size()));
+    content.resize(static_cast<std::size_t>(json_file.gcount()));
+
+    JsonSchemaProbe probe = ProbeProfilesSchema(content.data(), content.size());
+    if (probe == JSON_PROBE_NOT_PROFILES) {
+        file.cache_type = JsonProfileCache::ENTRY_NOT_A_PROFILE;
+        return;
     }
 
-    Json::Value root = Json::nullValue;
+    if (json_file) {
+        content.append(std::istreambuf_iterator<char>(json_file), std::istreambuf_iterator<char>());
+        if (probe == JSON_PROBE_INCOMPLETE) {
+            probe = ProbeProfilesSchema(content.data(), content.size());
+            if (probe == JSON_PROBE_NOT_PROFILES) {
+                file.cache_type = JsonProfileCache::ENTRY_NOT_A_PROFILE;
+                return;
+            }
+        }
+    }
+    json_file.close();
+
     Json::CharReaderBuilder builder;
+    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
     std::string errs;
-    bool success = Json::parseFromStream(builder, json_file, &root, &errs);
+    bool success = reader->parse(content.data(), content.data() + content.size(), &file.root, &errs);
     if (!success) {
-        LogMessage(&layer_settings, DEBUG_REPORT_ERROR_BIT, "Fail to parse file \\"%s\\" {\\n%s}\\n", filename.c_str(), errs.c_str());
-        return VK_SUCCESS;
+        file.root = Json::nullValue;
+        file.error = format("Fail to parse file \\"%s\\" {\\n%s}\\n", file.filename.c_str(), errs.c_str());
+        return;
     }
-    json_file.close();
 
-    if (root.type() != Json::objectValue) {
-        LogMessage(&layer_settings, DEBUG_REPORT_ERROR_BIT, "Json document root is not an object in file \\"%s\\"\\n", filename.c_str());
-        return VK_SUCCESS;
+    if (file.root.type() != Json::objectValue) {
+        file.root = Json::nullValue;
+        file.error = format("Json document root is not an object in file \\"%s\\"\\n", file.filename.c_str());
+        return;
+    }
+
+    const Json::Value& schema_node = static_cast<const Json::Value&>(file.root)["$schema"];
+    if (!schema_node.isString() ||
+        std::string(schema_node.asCString()).find("https://schema.khronos.org/vulkan/profiles") == std::string::npos) {
+        file.root = Json::nullValue;
+        file.cache_type = JsonProfileCache::ENTRY_NOT_A_PROFILE;
+        return;
+    }
+
+    if (layer_settings.simulate.profile_validation) {
+        ValidateFile(file);
+    }
+}
+
+void JsonLoader::ValidateFile(ProfileFile& file) const {
+    // The compiled schema is shared by the validators, so the files are validated concurrently by the worker threads
+    JsonValidator validator;
+    if (!validator.Init()) {
+        file.validation = ProfileFile::VALIDATION_NO_SCHEMA;
+    } else if (!validator.Check(file.root)) {
+        file.validation = ProfileFile::VALIDATION_FAILED;
+    } else {
+        file.validation = ProfileFile::VALIDATION_PASSED;
+        file.cache_type = JsonProfileCache::ENTRY_VALIDATED_PROFILE;
+    }
+}
+
+void JsonLoader::ReadFiles(std::vector<ProfileFile>& files) const {
+    const std::size_t hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::size_t thread_count = std::min(files.size(), std::min(hardware_threads, kMaxProfileLoadThreads));
+
+    // Each worker picks the next unread file, the results stay in the order of the files list
+    std::atomic<std::size_t> next_file{0};
+    const auto worker = [&]() {
+        for (std::size_t i = next_file++; i < files.size(); i = next_file++) {
+            ReadFile(files[i]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    if (thread_count > 1) {
+        threads.reserve(thread_count - 1);
+        for (std::size_t i = 1; i < thread_count; ++i) {
+            try {
+                threads.emplace_back(worker);
+            } catch (const std::system_error&) {
+                // The calling thread reads the remaining files
+                break;
+            }
+        }
     }
 
-    const Json::Value& schema_node = root["$schema"];
-    if (schema_node == Json::Value::nullSingleton()) {
+    worker();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+VkResult JsonLoader::AddFile(ProfileFile& file) {
+    if (!file.error.empty()) {
+        LogMessage(&layer_settings, DEBUG_REPORT_ERROR_BIT, "%s", file.error.c_str());
         return VK_SUCCESS;
     }
 
-    const std::string &schema = schema_node.asCString();
-    if (schema.find("https://schema.khronos.org/vulkan/profiles") == std::string::npos) {
+    const bool use_cache = !layer_settings.simulate.profile_cache.empty();
+
+    if (file.cache_type == JsonProfileCache::ENTRY_NOT_A_PROFILE) {
+        if (use_cache && !file.cached) {
+            profile_cache_.Store(file.filename, JsonProfileCache::ENTRY_NOT_A_PROFILE, Json::nullValue);
+        }
         return VK_SUCCESS;
     }
 
-    LogMessage(&layer_settings, DEBUG_REPORT_NOTIFICATION_BIT, "Loading \\"%s\\"\\n", filename.c_str());
+    if (file.cached) {
+        LogMessage(&layer_settings, DEBUG_REPORT_NOTIFICATION_BIT, "Loading \\"%s\\" from the profiles cache\\n", file.filename.c_str());
+    } else {
+        LogMessage(&layer_settings, DEBUG_REPORT_NOTIFICATION_BIT, "Loading \\"%s\\"\\n", file.filename.c_str());
+    }
 
-    if (layer_settings.simulate.profile_validation) {
-        JsonValidator validator;
-        if (!validator.Init()) {
-            LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT,
-                "%s could not find the profile schema file to validate filename. This operation requires the Vulkan SDK to be installed. Skipping profile file validation.\\n",
-                kLayerName, filename.c_str());
-        } else if (!validator.Check(root)) {
-            LogMessage(&layer_settings, DEBUG_REPORT_ERROR_BIT,
-                "%s is not a valid JSON profile file.\\n", filename.c_str());
-            if (layer_settings.log.debug_fail_on_error) {
-                return VK_ERROR_INITIALIZATION_FAILED;
-            } else {
-                return VK_SUCCESS;
-            }
+    if (file.validation == ProfileFile::VALIDATION_NO_SCHEMA) {
+        LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT,
+            "%s could not find the profile schema file to validate filename. This operation requires the Vulkan SDK to be installed. Skipping profile file validation.\\n",
+            kLayerName, file.filename.c_str());
+    } else if (file.validation == ProfileFile::VALIDATION_FAILED) {
+        LogMessage(&layer_settings, DEBUG_REPORT_ERROR_BIT,
+            "%s is not a valid JSON profile file.\\n", file.filename.c_str());
+        if (layer_settings.log.debug_fail_on_error) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        } else {
+            return VK_SUCCESS;
         }
     }
 
-    this->profiles_file_roots_.insert(std::pair(filename, root));
+    if (use_cache) {
+        profile_cache_.Store(file.filename, file.cache_type, file.root);
+    }
+
+    this->profiles_file_roots_.insert(std::pair(file.filename, std::move(file.root)));
 
     return VK_SUCCESS;
 }
 
 VkResult JsonLoader::LoadProfilesDatabase() {
+    const std::string& cache_filename = layer_settings.simulate.profile_cache;
+    if (!cache_filename.empty()) {
+        this->profile_cache_.Load(cache_filename, GetProfilesSchemaFilename());
+    }
+
+    std::vector<ProfileFile> files;
+
     if (!layer_settings.simulate.profile_file.empty()) {
-        VkResult result = this->LoadFile(layer_settings.simulate.profile_file);
-        if (result != VK_SUCCESS) {
-            return result;
-        }
+        files.push_back(ProfileFile{layer_settings.simulate.profile_file});
     }
 
     for (std::size_t i = 0, n = layer_settings.simulate.profile_dirs.size(); i < n; ++i) {
         const std::string& path = layer_settings.simulate.profile_dirs[i];
 
         if (fs::is_regular_file(path)) {
-            this->LoadFile(path);
+            files.push_back(ProfileFile{path});
             continue;
         }
 
+        // Sort the files of each directory so that the loading order doesn't depend on the file system
+        std::vector<std::string> dir_files;
         for (const auto& entry : fs::directory_iterator(path)) {
             if (fs::is_directory(entry.path())) {
                 continue;
@@ -2067,10 +2415,29 @@ VkResult JsonLoader::LoadProfilesDatabase() {
                 continue;
             }
 
-            VkResult result = this->LoadFile(file_path);
-            if (result != VK_SUCCESS) {
-                continue;
-            }
+            dir_files.push_back(file_path);
+        }
+        std::sort(dir_files.begin(), dir_files.end());
+
+        for (std::string& file_path : dir_files) {
+            files.push_back(ProfileFile{std::move(file_path)});
+        }
+    }
+
+    ReadFiles(files);
+
+    for (std::size_t i = 0, n = files.size(); i < n; ++i) {
+        VkResult result = this->AddFile(files[i]);
+
+        // Only a failure of the profile_file is reported, invalid files of profile_dirs are skipped
+        if (result != VK_SUCCESS && i == 0 && !layer_settings.simulate.profile_file.empty()) {
+            return result;
+        }
+    }
+
+    if (!cache_filename.empty() && this->profile_cache_.IsDirty()) {
+        if (!this->profile_cache_.Save(cache_filename)) {
+            LogMessage(&layer_settings, DEBUG_REPORT_WARNING_BIT, "Fail to write the profiles cache \\"%s\\"\\n", cache_filename.c_str());
         }
     }
 
@@ -2135,14 +2502,19 @@ void JsonLoader::ReadProfileApiVersion() {
         std::sscanf(version_string.c_str(), "%u.%u.%u", &api_major, &api_minor, &api_patch);
         profile_api_version_ = VK_MAKE_API_VERSION(0, api_major, api_minor, api_patch);
     }
+}
 
+// The exclusion settings are compiled once, the queries only look up the sets
+void JsonLoader::CompileExclusions() {
     for (const auto& extension : layer_settings.simulate.exclude_device_extensions) {
         if (extension.empty()) continue;
-        excluded_extensions_.push_back(extension);
+        excluded_extensions_.insert(extension);
     }
     for (const auto& format : layer_settings.simulate.exclude_formats) {
         if (format.empty()) continue;
-        excluded_formats_.push_back(format);
+        const VkFormat excluded_format = StringToFormat(format);
+        if (excluded_format == VK_FORMAT_UNDEFINED) continue;
+        excluded_formats_.insert(excluded_format);
     }
 }
 
@@ -2315,6 +2687,25 @@ GET_DEFINES = '''
         valid = false;                                                                  \\
     }
 
+// Entry of the sorted table of the members of a structure read by a JsonLoader::GetStruct function
+struct JsonMember {
+    const char *name;
+    uint32_t index;
+};
+
+// Returns the index associated with a member name by a JsonMember table, or UINT32_MAX when the member is unknown
+template <std::size_t N>
+static uint32_t FindJsonMember(const JsonMember (&members)[N], const std::string &name) {
+    const JsonMember *end = members + N;
+    const JsonMember *it = std::lower_bound(members, end, name.c_str(), [](const JsonMember &member, const char *value) {
+        return std::strcmp(member.name, value) < 0;
+    });
+    if (it == end || std::strcmp(it->name, name.c_str()) != 0) {
+        return UINT32_MAX;
+    }
+    return it->index;
+}
+
 '''
 
 GET_UNDEFINE = '''
@@ -2346,11 +2737,17 @@ static VkResult LayerSetupCreateInstance(const VkInstanceCreateInfo *pCreateInfo
 
 VKAPI_ATTR VkResult VKAPI_CALL CreateInstance(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator,
                                               VkInstance *pInstance) {
-    JsonLoader &json_loader = JsonLoader::Create();
+    JsonLoader *created_json_loader = nullptr;
+    {
+        std::unique_lock<std::shared_mutex> lock(instance_lock);
+        created_json_loader = &JsonLoader::Create();
+    }
+    JsonLoader &json_loader = *created_json_loader;
 
     ProfileLayerSettings *layer_settings = &json_loader.layer_settings;
 
     InitProfilesLayerSettings(pCreateInfo, pAllocator, layer_settings);
+    json_loader.CompileExclusions();
 
     LogMessage(layer_settings, DEBUG_REPORT_DEBUG_BIT, "CreateInstance\\n");
     LogMessage(layer_settings, DEBUG_REPORT_DEBUG_BIT, "JsonCpp version %s\\n", JSONCPP_VERSION_STRING);
@@ -2366,10 +2763,12 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateInstance(const VkInstanceCreateInfo *pCreat
     requested_version = (app_info && app_info->apiVersion) ? app_info->apiVersion : VK_API_VERSION_1_0;
     if (VK_API_VERSION_MAJOR(requested_version) > VK_API_VERSION_MAJOR(VK_HEADER_VERSION_COMPLETE) ||
         VK_API_VERSION_MINOR(requested_version) > VK_API_VERSION_MINOR(VK_HEADER_VERSION_COMPLETE)) {
-        LogMessage(layer_settings, DEBUG_REPORT_ERROR_BIT, "The Vulkan application requested a Vulkan %s instance but the %s was build "
-                                                    "against %s. Please, update the layer.\\n",
-                                                    StringAPIVersion(requested_version).c_str(), kLayerName,
-                                                    StringAPIVersion(VK_HEADER_VERSION_COMPLETE).c_str());
+        if (IsLogEnabled(layer_settings, DEBUG_REPORT_ERROR_BIT)) {
+            LogMessage(layer_settings, DEBUG_REPORT_ERROR_BIT, "The Vulkan application requested a Vulkan %s instance but the %s was build "
+                                                        "against %s. Please, update the layer.\\n",
+                                                        StringAPIVersion(requested_version).c_str(), kLayerName,
+                                                        StringAPIVersion(VK_HEADER_VERSION_COMPLETE).c_str());
+        }
         if (layer_settings->log.debug_fail_on_error) {
             return VK_ERROR_INITIALIZATION_FAILED;
         }
@@ -2382,24 +2781,26 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateInstance(const VkInstanceCreateInfo *pCreat
         if (VK_API_VERSION_MAJOR(requested_version) < VK_API_VERSION_MAJOR(profile_api_version) ||
             VK_API_VERSION_MINOR(requested_version) < VK_API_VERSION_MINOR(profile_api_version)) {
             if (layer_settings->simulate.capabilities & SIMULATE_API_VERSION_BIT) {
-                if (layer_settings->simulate.profile_name.empty()) {
-                    LogMessage(layer_settings,
-                        DEBUG_REPORT_NOTIFICATION_BIT,
-                        "The Vulkan application requested a Vulkan %s instance but the selected %s file requires %s. The "
-                                 "application requested instance version is overridden to %s.\\n",
-                                 StringAPIVersion(requested_version).c_str(), layer_settings->simulate.profile_file.c_str(),
-                                 StringAPIVersion(profile_api_version).c_str(), StringAPIVersion(profile_api_version).c_str());
-                } else {
-                    LogMessage(layer_settings,
-                        DEBUG_REPORT_NOTIFICATION_BIT,
-                        "The Vulkan application requested a Vulkan %s instance but the selected %s profile requires %s. "
-                                 "The application requested instance version is overridden to %s.\\n",
-                                 StringAPIVersion(requested_version).c_str(), layer_settings->simulate.profile_name.c_str(),
-                                 StringAPIVersion(profile_api_version).c_str(), StringAPIVersion(profile_api_version).c_str());
+                if (IsLogEnabled(layer_settings, DEBUG_REPORT_NOTIFICATION_BIT)) {
+                    if (layer_settings->simulate.profile_name.empty()) {
+                        LogMessage(layer_settings,
+                            DEBUG_REPORT_NOTIFICATION_BIT,
+                            "The Vulkan application requested a Vulkan %s instance but the selected %s file requires %s. The "
+                                     "application requested instance version is overridden to %s.\\n",
+                                     StringAPIVersion(requested_version).c_str(), layer_settings->simulate.profile_file.c_str(),
+                                     StringAPIVersion(profile_api_version).c_str(), StringAPIVersion(profile_api_version).c_str());
+                    } else {
+                        LogMessage(layer_settings,
+                            DEBUG_REPORT_NOTIFICATION_BIT,
+                            "The Vulkan application requested a Vulkan %s instance but the selected %s profile requires %s. "
+                                     "The application requested instance version is overridden to %s.\\n",
+                                     StringAPIVersion(requested_version).c_str(), layer_settings->simulate.profile_name.c_str(),
+                                     StringAPIVersion(profile_api_version).c_str(), StringAPIVersion(profile_api_version).c_str());
+                    }
                 }
                 requested_version = profile_api_version;
                 changed_version = true;
-            } else {
+            } else if (IsLogEnabled(layer_settings, DEBUG_REPORT_WARNING_BIT)) {
                 if (layer_settings->simulate.profile_name.empty()) {
                     LogMessage(layer_settings,
                         DEBUG_REPORT_WARNING_BIT,
@@ -2419,7 +2820,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateInstance(const VkInstanceCreateInfo *pCreat
         }
     }
 
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
+    std::unique_lock<std::shared_mutex> lock(instance_lock);
 
     bool get_physical_device_properties2_active = false;
     if (VK_API_VERSION_MINOR(requested_version) > 0) {
@@ -2503,7 +2904,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateInstance(const VkInstanceCreateInfo *pCreat
 
 VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocationCallbacks *pAllocator) {
     if (instance) {
-        std::lock_guard<std::recursive_mutex> lock(global_lock);
+        std::unique_lock<std::shared_mutex> lock(instance_lock);
 
         ProfileLayerSettings* layer_settings = &JsonLoader::Find(instance)->layer_settings;
 
@@ -2519,18 +2920,33 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
             assert(!err);
             if (!err)
                 for (const auto pd : physical_devices) PhysicalDeviceData::Destroy(pd);
+            PhysicalDeviceData::Publish();
 
             dt->DestroyInstance(instance, pAllocator);
         }
         destroy_instance_dispatch_table(get_dispatch_key(instance));
 
+        LogFlush(layer_settings);
+
         JsonLoader::Destroy(instance);
     }
 }
 '''
 
 FORMAT_PROPERTIES_PNEXT = '''
-void FillFormatPropertiesPNextChain(PhysicalDeviceData *physicalDeviceData, void *place, VkFormat format) {
+// True when FillFormatPropertiesPNextChain overrides every structure of the chain, so the driver doesn't need to fill it
+bool IsFormatPropertiesPNextChainSimulated(const PhysicalDeviceData *physicalDeviceData, const void *place) {
+    while (place) {
+        const VkBaseInStructure *structure = (const VkBaseInStructure *)place;
+        if (structure->sType != VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3 || physicalDeviceData->map_of_format_properties_3_.empty()) {
+            return false;
+        }
+        place = structure->pNext;
+    }
+    return true;
+}
+
+void FillFormatPropertiesPNextChain(const PhysicalDeviceData *physicalDeviceData, void *place, VkFormat format) {
     while (place) {
         VkBaseOutStructure *structure = (VkBaseOutStructure *)place;
 
@@ -2542,7 +2958,13 @@ void FillFormatPropertiesPNextChain(PhysicalDeviceData *physicalDeviceData, void
                 if (!physicalDeviceData->map_of_format_properties_3_.empty()) {
                     VkFormatProperties3 *sp = (VkFormatProperties3 *)place;
                     void *pNext = sp->pNext;
-                    *sp = physicalDeviceData->map_of_format_properties_3_[format];
+                    // Published PDDs are immutable, look up the format without inserting into the map
+                    const auto iter = physicalDeviceData->map_of_format_properties_3_.find(format);
+                    if (iter != physicalDeviceData->map_of_format_properties_3_.end()) {
+                        *sp = iter->second;
+                    } else {
+                        *sp = VkFormatProperties3{VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3};
+                    }
                     sp->pNext = pNext;
                 }
             } break;
@@ -2557,10 +2979,10 @@ void FillFormatPropertiesPNextChain(PhysicalDeviceData *physicalDeviceData, void
 
 GET_PHYSICAL_DEVICE_FEATURES_PROPERTIES_FUNCTIONS = '''
 VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties *pProperties) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
 
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
     if (pdd) {
         *pProperties = pdd->physical_device_properties_;
     } else {
@@ -2571,15 +2993,17 @@ VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceProperties(VkPhysicalDevice physical
 void GetPhysicalDeviceProperties2Impl(VkPhysicalDevice physicalDevice,
                                       VkPhysicalDeviceProperties2KHR *pProperties,
                                       bool core) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
     if (core) {
         dt->GetPhysicalDeviceProperties2(physicalDevice, pProperties);
     } else {
         dt->GetPhysicalDeviceProperties2KHR(physicalDevice, pProperties);
     }
-    GetPhysicalDeviceProperties(physicalDevice, &pProperties->properties);
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    if (pdd) {
+        pProperties->properties = pdd->physical_device_properties_;
+    }
     FillPNextChain(pdd, pProperties->pNext);
 }
 
@@ -2594,10 +3018,10 @@ VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceProperties2KHR(VkPhysicalDevice phys
 }
 
 VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceFeatures(VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures *pFeatures) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
 
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
     if (pdd) {
         *pFeatures = pdd->physical_device_features_;
     } else {
@@ -2606,12 +3030,12 @@ VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceFeatures(VkPhysicalDevice physicalDe
 }
 
 void GetPhysicalDeviceFeatures2Impl(VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures2KHR *pFeatures, bool core) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
 
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
     if (pdd) {
-        ProfileLayerSettings *layer_settings = &JsonLoader::Find(pdd->instance())->layer_settings;
+        ProfileLayerSettings *layer_settings = pdd->layer_settings();
         if (layer_settings->simulate.unknown_feature_values == UNKNOWN_FEATURE_VALUES_DEVICE) {
             if (core) {
                 dt->GetPhysicalDeviceFeatures2(physicalDevice, pFeatures);
@@ -2620,6 +3044,7 @@ void GetPhysicalDeviceFeatures2Impl(VkPhysicalDevice physicalDevice, VkPhysicalD
             }
         }
         FillPNextChain(pdd, pFeatures->pNext);
+        pFeatures->features = pdd->physical_device_features_;
     } else {
         if (core) {
             dt->GetPhysicalDeviceFeatures2(physicalDevice, pFeatures);
@@ -2627,8 +3052,6 @@ void GetPhysicalDeviceFeatures2Impl(VkPhysicalDevice physicalDevice, VkPhysicalD
             dt->GetPhysicalDeviceFeatures2KHR(physicalDevice, pFeatures);
         }
     }
-
-    GetPhysicalDeviceFeatures(physicalDevice, &pFeatures->features);
 }
 
 VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceFeatures2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures2KHR *pFeatures) {
@@ -2658,13 +3081,13 @@ VKAPI_ATTR VkResult VKAPI_CALL EnumerateInstanceExtensionProperties(const char *
 VKAPI_ATTR VkResult VKAPI_CALL EnumerateDeviceExtensionProperties(VkPhysicalDevice physicalDevice, const char *pLayerName,
                                                                   uint32_t *pCount, VkExtensionProperties *pProperties) {
     VkResult result = VK_SUCCESS;
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
 
     uint32_t pCount_copy = *pCount;
 
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
-    ProfileLayerSettings* layer_settings = &JsonLoader::Find(pdd->instance())->layer_settings;
+    ProfileLayerSettings* layer_settings = pdd->layer_settings();
     if (pLayerName) {
         if (strcmp(pLayerName, kLayerName) == 0)
             result = EnumerateProperties(kDeviceExtensionPropertiesCount, kDeviceExtensionProperties.data(), pCount, pProperties);
@@ -2678,7 +3101,7 @@ VKAPI_ATTR VkResult VKAPI_CALL EnumerateDeviceExtensionProperties(VkPhysicalDevi
     }
 
     if (result == VK_SUCCESS && !pLayerName && layer_settings->simulate.emulate_portability &&
-        !PhysicalDeviceData::HasSimulatedOrRealExtension(physicalDevice, VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME)) {
+        !PhysicalDeviceData::HasSimulatedOrRealExtension(pdd, VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME)) {
         if (pProperties) {
             if (pCount_copy >= *pCount + 1) {
                 strncpy(pProperties[*pCount].extensionName, VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE);
@@ -2698,11 +3121,10 @@ QUEUE_FAMILY_PROPERTIES_FUNCTIONS = '''
 VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice physicalDevice,
                                                                   uint32_t *pQueueFamilyPropertyCount,
                                                                   VkQueueFamilyProperties *pQueueFamilyProperties) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
-
     // Are there JSON overrides, or should we call down to return the original values?
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
     const uint32_t src_count = (pdd) ? static_cast<uint32_t>(pdd->arrayof_queue_family_properties_.size()) : 0;
     if (src_count == 0) {
         dt->GetPhysicalDeviceQueueFamilyProperties(physicalDevice, pQueueFamilyPropertyCount, pQueueFamilyProperties);
@@ -2726,11 +3148,10 @@ void GetPhysicalDeviceQueueFamilyProperties2Impl(VkPhysicalDevice physicalDevice
                                                  uint32_t *pQueueFamilyPropertyCount,
                                                  VkQueueFamilyProperties2KHR *pQueueFamilyProperties2,
                                                  bool core) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
-
     // Are there JSON overrides, or should we call down to return the original values?
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
     const uint32_t src_count = (pdd) ? static_cast<uint32_t>(pdd->arrayof_queue_family_properties_.size()) : 0;
     if (src_count == 0) {
         if (core) {
@@ -2770,70 +3191,70 @@ VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceQueueFamilyProperties2(VkPhysicalDev
 '''
 
 PHYSICAL_DEVICE_FORMAT_FUNCTIONS = '''
-VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceFormatProperties(VkPhysicalDevice physicalDevice, VkFormat format,
-                                                             VkFormatProperties *pFormatProperties) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
-
-    // Are there JSON overrides, or should we call down to return the original values?
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
-    ProfileLayerSettings* layer_settings = &JsonLoader::Find(pdd->instance())->layer_settings;
-
+// The answer is fixed once the profiles are loaded for excluded formats, for the formats of the profiles and, when the formats
+// are simulated, for the formats missing from the profiles. Only the other formats need to call down to the driver.
+static bool GetSimulatedFormatProperties(const PhysicalDeviceData *pdd, VkFormat format, VkFormatProperties *pFormatProperties) {
     // Check if Format was excluded
-    for (std::size_t j = 0, m = layer_settings->simulate.exclude_formats.size(); j < m; ++j) {
-        const std::string &excluded_format = layer_settings->simulate.exclude_formats[j];
-        if (excluded_format.empty()) continue;
+    if (pdd->excluded_formats_.count(format) > 0) {
+        *pFormatProperties = VkFormatProperties{};
+        return true;
+    }
 
-        if (StringToFormat(excluded_format) == format) {
-            *pFormatProperties = VkFormatProperties{};
-            return;
-        }
+    if (pdd->map_of_format_properties_.empty()) {
+        return false;
     }
 
-    const uint32_t src_count = (pdd) ? static_cast<uint32_t>(pdd->map_of_format_properties_.size()) : 0;
-    if (src_count == 0) {
-        dt->GetPhysicalDeviceFormatProperties(physicalDevice, format, pFormatProperties);
-    } else {
-        VkFormatProperties device_format = {};
-        dt->GetPhysicalDeviceFormatProperties(physicalDevice, format, &device_format);
-        const auto iter = pdd->map_of_format_properties_.find(format);
+    const auto iter = pdd->map_of_format_properties_.find(format);
+    if (pdd->layer_settings()->simulate.capabilities & SIMULATE_FORMATS_BIT) {
+        *pFormatProperties = (iter != pdd->map_of_format_properties_.end()) ? iter->second : VkFormatProperties{};
+        return true;
+    }
 
-        if ((layer_settings->simulate.capabilities & SIMULATE_FORMATS_BIT)) {
-            *pFormatProperties = (iter != pdd->map_of_format_properties_.end()) ? iter->second : VkFormatProperties{};
-        } else {
-            *pFormatProperties = device_format;
-        }
+    // The device properties of the profile formats are loaded when the PDD is populated
+    const auto device_iter = pdd->device_formats_.find(format);
+    if (iter != pdd->map_of_format_properties_.end() && device_iter != pdd->device_formats_.end()) {
+        *pFormatProperties = device_iter->second;
+        return true;
+    }
 
-        if (IsFormatSupported(*pFormatProperties) && iter != pdd->map_of_format_properties_.end()) {
-            if ((layer_settings->simulate.capabilities & SIMULATE_FORMATS_BIT)) {
-                *pFormatProperties = iter->second;
-            } else {
-                *pFormatProperties = device_format;
-            }
+    return false;
+}
 
-            if (!HasFlags(device_format.linearTilingFeatures, pFormatProperties->linearTilingFeatures) ||
-                !HasFlags(device_format.optimalTilingFeatures, pFormatProperties->optimalTilingFeatures) ||
-                !HasFlags(device_format.bufferFeatures, pFormatProperties->bufferFeatures)) {
-                LogMessage(layer_settings, DEBUG_REPORT_WARNING_BIT,
-                           "format %s is simulating unsupported features!\\n", vkFormatToString(format).c_str());
-            }
-        }
+static void GetFormatProperties(VkPhysicalDevice physicalDevice, const PhysicalDeviceData *pdd, VkFormat format,
+                                VkFormatProperties *pFormatProperties) {
+    if (pdd != nullptr && GetSimulatedFormatProperties(pdd, format, pFormatProperties)) {
+        return;
     }
 
-    LogFlush(layer_settings);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
+    dt->GetPhysicalDeviceFormatProperties(physicalDevice, format, pFormatProperties);
+}
+
+VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceFormatProperties(VkPhysicalDevice physicalDevice, VkFormat format,
+                                                             VkFormatProperties *pFormatProperties) {
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    GetFormatProperties(physicalDevice, pdd, format, pFormatProperties);
 }
 
 void GetPhysicalDeviceFormatProperties2Impl(VkPhysicalDevice physicalDevice, VkFormat format,
                                             VkFormatProperties2KHR *pFormatProperties, bool core) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+
+    if (pdd != nullptr && IsFormatPropertiesPNextChainSimulated(pdd, pFormatProperties->pNext) &&
+        GetSimulatedFormatProperties(pdd, format, &pFormatProperties->formatProperties)) {
+        FillFormatPropertiesPNextChain(pdd, pFormatProperties->pNext, format);
+        return;
+    }
+
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
     if (core) {
         dt->GetPhysicalDeviceFormatProperties2(physicalDevice, format, pFormatProperties);
     } else {
         dt->GetPhysicalDeviceFormatProperties2KHR(physicalDevice, format, pFormatProperties);
     }
-    GetPhysicalDeviceFormatProperties(physicalDevice, format, &pFormatProperties->formatProperties);
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    GetFormatProperties(physicalDevice, pdd, format, &pFormatProperties->formatProperties);
     FillFormatPropertiesPNextChain(pdd, pFormatProperties->pNext, format);
 }
 
@@ -2847,44 +3268,64 @@ VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceFormatProperties2KHR(VkPhysicalDevic
     GetPhysicalDeviceFormatProperties2Impl(physicalDevice, format, pFormatProperties, false);
 }
 
+// The driver answers don't change, so when image_format_cache_size is set they are remembered by the PDD
+template <typename CallDown>
+static VkResult GetDeviceImageFormatProperties(const PhysicalDeviceData *pdd, const ImageFormatQuery &query,
+                                               VkImageFormatProperties *pImageFormatProperties, CallDown call_down) {
+    if (pdd == nullptr || pdd->layer_settings()->simulate.image_format_cache_size == 0) {
+        return call_down();
+    }
+
+    ImageFormatAnswer answer{};
+    if (pdd->FindImageFormatProperties(query, &answer)) {
+        *pImageFormatProperties = answer.properties;
+        return answer.result;
+    }
+
+    answer.result = call_down();
+    answer.properties = *pImageFormatProperties;
+    pdd->StoreImageFormatProperties(query, answer);
+    return answer.result;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceImageFormatProperties(VkPhysicalDevice physicalDevice, VkFormat format,
                                                                       VkImageType type, VkImageTiling tiling,
                                                                       VkImageUsageFlags usage, VkImageCreateFlags flags,
                                                                       VkImageFormatProperties *pImageFormatProperties) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
+    ProfileLayerSettings* layer_settings = pdd->layer_settings();
 
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
-    ProfileLayerSettings* layer_settings = &JsonLoader::Find(pdd->instance())->layer_settings;
+    const ImageFormatQuery query{format, type, tiling, usage, flags};
+    auto call_down = [&]() {
+        return dt->GetPhysicalDeviceImageFormatProperties(physicalDevice, format, type, tiling, usage, flags,
+                                                          pImageFormatProperties);
+    };
 
     // Are there JSON overrides, or should we call down to return the original values?
     if (!(layer_settings->simulate.capabilities & SIMULATE_FORMATS_BIT)) {
-        return dt->GetPhysicalDeviceImageFormatProperties(physicalDevice, format, type, tiling, usage, flags,
-                                                          pImageFormatProperties);
+        return GetDeviceImageFormatProperties(pdd, query, pImageFormatProperties, call_down);
     }
 
     VkFormatProperties fmt_props = {};
-    GetPhysicalDeviceFormatProperties(physicalDevice, format, &fmt_props);
+    GetFormatProperties(physicalDevice, pdd, format, &fmt_props);
 
     if (!IsFormatSupported(fmt_props)) {
         *pImageFormatProperties = VkImageFormatProperties{};
         return VK_ERROR_FORMAT_NOT_SUPPORTED;
     }
 
-    VkResult result =
-        dt->GetPhysicalDeviceImageFormatProperties(physicalDevice, format, type, tiling, usage, flags, pImageFormatProperties);
-
-    return result;
+    return GetDeviceImageFormatProperties(pdd, query, pImageFormatProperties, call_down);
 }
 
 VkResult GetPhysicalDeviceImageFormatProperties2Impl(
     VkPhysicalDevice physicalDevice, const VkPhysicalDeviceImageFormatInfo2KHR *pImageFormatInfo,
     VkImageFormatProperties2KHR *pImageFormatProperties, bool core) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
-
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
-    ProfileLayerSettings* layer_settings = &JsonLoader::Find(pdd->instance())->layer_settings;
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
+    ProfileLayerSettings* layer_settings = pdd->layer_settings();
 
     if (layer_settings->simulate.capabilities & SIMULATE_VIDEO_FORMATS_BIT) {
         // If video profile lists are provided, make sure to only report support for actually supported video formats
@@ -2933,10 +3374,21 @@ VkResult GetPhysicalDeviceImageFormatProperties2Impl(
         }
     }
 
-    if (core) {
-        return dt->GetPhysicalDeviceImageFormatProperties2(physicalDevice, pImageFormatInfo, pImageFormatProperties);
+    auto call_down = [&]() {
+        if (core) {
+            return dt->GetPhysicalDeviceImageFormatProperties2(physicalDevice, pImageFormatInfo, pImageFormatProperties);
+        }
+        return dt->GetPhysicalDeviceImageFormatProperties2KHR(physicalDevice, pImageFormatInfo, pImageFormatProperties);
+    };
+
+    // The structures chained to the query or to the answer are not part of the cache key
+    if (pImageFormatInfo->pNext != nullptr || pImageFormatProperties->pNext != nullptr) {
+        return call_down();
     }
-    return dt->GetPhysicalDeviceImageFormatProperties2KHR(physicalDevice, pImageFormatInfo, pImageFormatProperties);
+
+    const ImageFormatQuery query{pImageFormatInfo->format, pImageFormatInfo->type, pImageFormatInfo->tiling,
+                                 pImageFormatInfo->usage, pImageFormatInfo->flags};
+    return GetDeviceImageFormatProperties(pdd, query, &pImageFormatProperties->imageFormatProperties, call_down);
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceImageFormatProperties2KHR(
@@ -2956,11 +3408,10 @@ PHYSICAL_DEVICE_VIDEO_FUNCTIONS = '''
 VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceVideoCapabilitiesKHR(VkPhysicalDevice physicalDevice,
                                                                      const VkVideoProfileInfoKHR *pVideoProfile,
                                                                      VkVideoCapabilitiesKHR *pCapabilities) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
-
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
-    ProfileLayerSettings* layer_settings = &JsonLoader::Find(pdd->instance())->layer_settings;
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
+    ProfileLayerSettings* layer_settings = pdd->layer_settings();
 
     if (layer_settings->simulate.capabilities & SIMULATE_VIDEO_CAPABILITIES_BIT) {
         VideoProfileData in_video_profile{};
@@ -2988,11 +3439,10 @@ VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceVideoFormatPropertiesKHR(VkPhysi
                                                                          const VkPhysicalDeviceVideoFormatInfoKHR *pVideoFormatInfo,
                                                                          uint32_t *pVideoFormatPropertyCount,
                                                                          VkVideoFormatPropertiesKHR *pVideoFormatProperties) {
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
-    const auto dt = instance_dispatch_table(physicalDevice);
-
-    PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
-    ProfileLayerSettings* layer_settings = &JsonLoader::Find(pdd->instance())->layer_settings;
+    const PhysicalDeviceData *pdd = PhysicalDeviceData::Find(physicalDevice);
+    const auto lock = PhysicalDeviceData::LockIfUnpublished(pdd);
+    const auto dt = PhysicalDeviceData::DispatchTable(pdd, physicalDevice);
+    ProfileLayerSettings* layer_settings = pdd->layer_settings();
 
     if (layer_settings->simulate.capabilities & SIMULATE_VIDEO_FORMATS_BIT) {
         auto p = reinterpret_cast<const VkBaseInStructure*>(pVideoFormatInfo);
@@ -3199,16 +3649,83 @@ void LoadQueueFamilyProperties(VkInstance instance, VkPhysicalDevice pd, Physica
 '''
 
 LOAD_VIDEO_PROFILES = '''
+// Identifies the driver of a physical device: video profiles probed on a device are reused for any device of any instance of
+// the process using the same driver, as probing costs a video capabilities query for every combination of video profile values.
+struct VideoProbeKey {
+    std::array<uint8_t, VK_UUID_SIZE> driver_uuid;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    uint32_t api_version;
+    bool load_formats;
+
+    bool operator<(const VideoProbeKey &rhs) const {
+        return std::tie(driver_uuid, vendor_id, device_id, driver_version, api_version, load_formats) <
+               std::tie(rhs.driver_uuid, rhs.vendor_id, rhs.device_id, rhs.driver_version, rhs.api_version, rhs.load_formats);
+    }
+};
+
+// Only accessed by EnumeratePhysicalDevices while it holds instance_lock
+static std::map<VideoProbeKey, SetOfVideoProfiles> &video_probe_cache() {
+    static std::map<VideoProbeKey, SetOfVideoProfiles> cache;
+    return cache;
+}
+
+static bool GetVideoProbeKey(VkuInstanceDispatchTable *dt, VkPhysicalDevice pd, const PhysicalDeviceData *pdd,
+                             SimulateCapabilityFlags flags, VideoProbeKey *key) {
+    VkPhysicalDeviceIDProperties id_properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES};
+    VkPhysicalDeviceProperties2 properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &id_properties};
+    // The core entry point needs a Vulkan 1.1 instance, CreateInstance otherwise enables VK_KHR_get_physical_device_properties2
+    if (requested_version >= VK_API_VERSION_1_1) {
+        dt->GetPhysicalDeviceProperties2(pd, &properties);
+    } else {
+        dt->GetPhysicalDeviceProperties2KHR(pd, &properties);
+    }
+
+    // Without a driver UUID, the driver can't be told apart from another one
+    if (std::all_of(std::begin(id_properties.driverUUID), std::end(id_properties.driverUUID), [](uint8_t byte) { return byte == 0; })) {
+        return false;
+    }
+
+    std::copy(std::begin(id_properties.driverUUID), std::end(id_properties.driverUUID), key->driver_uuid.begin());
+    key->vendor_id = properties.properties.vendorID;
+    key->device_id = properties.properties.deviceID;
+    key->driver_version = properties.properties.driverVersion;
+    key->api_version = pdd->GetDeviceEffectiveVersion();
+    key->load_formats = (flags & SIMULATE_VIDEO_FORMATS_BIT) != 0;
+    return true;
+}
+
+// Called by JsonLoader::ReadProfile while the PDD is populated, the first time a profile defines video profiles
 static void LoadVideoProfiles(VkInstance instance, VkPhysicalDevice pd, PhysicalDeviceData *pdd, SimulateCapabilityFlags flags) {
-    if (!PhysicalDeviceData::HasExtension(pdd, "VK_KHR_video_queue")) {
+    if (pdd->device_video_profiles_loaded_) {
         return;
     }
+    pdd->device_video_profiles_loaded_ = true;
 
-    auto check_api_version = [&](uint32_t api_version) { return pdd->GetEffectiveVersion() >= api_version; };
-    auto check_extension = [&](const char* extension) { return PhysicalDeviceData::HasExtension(pdd, extension); };
+    if (!PhysicalDeviceData::HasExtension(pdd, "VK_KHR_video_queue")) {
+        return;
+    }
 
     const auto dt = instance_dispatch_table(instance);
     ProfileLayerSettings *layer_settings = &JsonLoader::Find(instance)->layer_settings;
+
+    // A previous profile may already have overridden the PDD API version, the chains are built for the driver version
+    const uint32_t device_api_version = pdd->GetDeviceEffectiveVersion();
+
+    auto check_api_version = [&](uint32_t api_version) { return device_api_version >= api_version; };
+    auto check_extension = [&](const char* extension) { return PhysicalDeviceData::HasExtension(pdd, extension); };
+
+    VideoProbeKey probe_key{};
+    const bool use_probe_cache = GetVideoProbeKey(dt, pd, pdd, flags, &probe_key);
+    if (use_probe_cache) {
+        const auto cached = video_probe_cache().find(probe_key);
+        if (cached != video_probe_cache().end()) {
+            pdd->set_of_device_video_profiles_ = cached->second;
+            return;
+        }
+    }
+
     ForEachVideoProfile([&](const VkVideoProfileInfoKHR& info, const char *name) {
         VideoProfileData video_profile{};
 
@@ -3277,6 +3794,10 @@ static void LoadVideoProfiles(VkInstance instance, VkPhysicalDevice pd, Physical
         // Store video profile data in the physical device data
         pdd->set_of_device_video_profiles_.insert(video_profile);
     });
+
+    if (use_probe_cache) {
+        video_probe_cache()[probe_key] = pdd->set_of_device_video_profiles_;
+    }
 }
 '''
 
@@ -3285,7 +3806,7 @@ VKAPI_ATTR VkResult VKAPI_CALL EnumeratePhysicalDevices(VkInstance instance, uin
                                                         VkPhysicalDevice *pPhysicalDevices) {
     // Our layer-specific initialization...
 
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
+    std::unique_lock<std::shared_mutex> lock(instance_lock);
     const auto dt = instance_dispatch_table(instance);
 
     ProfileLayerSettings *layer_settings = &JsonLoader::Find(instance)->layer_settings;
@@ -3311,7 +3832,7 @@ VKAPI_ATTR VkResult VKAPI_CALL EnumeratePhysicalDevices(VkInstance instance, uin
                 continue;
             }
 
-            PhysicalDeviceData &pdd = PhysicalDeviceData::Create(physical_device, instance);
+            PhysicalDeviceData &pdd = PhysicalDeviceData::Create(physical_device, instance, layer_settings);
             ArrayOfVkExtensionProperties local_device_extensions;
             EnumerateAll<VkExtensionProperties>(local_device_extensions, [&](uint32_t *count, VkExtensionProperties *results) {
                 return dt->EnumerateDeviceExtensionProperties(physical_device, nullptr, count, results);
@@ -3325,14 +3846,19 @@ VKAPI_ATTR VkResult VKAPI_CALL EnumeratePhysicalDevices(VkInstance instance, uin
             pdd.simulation_extensions_ = pdd.device_extensions_;
 
             dt->GetPhysicalDeviceProperties(physical_device, &pdd.physical_device_properties_);
+            pdd.device_api_version_ = pdd.physical_device_properties_.apiVersion;
             uint32_t effective_api_version = pdd.GetEffectiveVersion();
             bool api_version_above_1_1 = effective_api_version >= VK_API_VERSION_1_1;
             bool api_version_above_1_2 = effective_api_version >= VK_API_VERSION_1_2;
             bool api_version_above_1_3 = effective_api_version >= VK_API_VERSION_1_3;
             bool api_version_above_1_4 = effective_api_version >= VK_API_VERSION_1_4;
 
-            ::device_has_astc_hdr = ::PhysicalDeviceData::HasExtension(&pdd, VK_EXT_TEXTURE_COMPRESSION_ASTC_HDR_EXTENSION_NAME);
-            ::device_has_pvrtc = ::PhysicalDeviceData::HasExtension(&pdd, VK_IMG_FORMAT_PVRTC_EXTENSION_NAME);
+            if (::PhysicalDeviceData::HasExtension(&pdd, VK_EXT_TEXTURE_COMPRESSION_ASTC_HDR_EXTENSION_NAME)) {
+                pdd.device_texture_compression_ |= TEXTURE_COMPRESSION_ASTC_HDR_BIT;
+            }
+            if (::PhysicalDeviceData::HasExtension(&pdd, VK_IMG_FORMAT_PVRTC_EXTENSION_NAME)) {
+                pdd.device_texture_compression_ |= TEXTURE_COMPRESSION_PVRTC_BIT;
+            }
 
             // Initialize PDD members to the actual Vulkan implementation's defaults.
             {
@@ -3387,19 +3913,19 @@ ENUMERATE_PHYSICAL_DEVICES_MIDDLE = '''
                 pdd.physical_device_memory_properties_ = memory_chain.memoryProperties;
             }
 
-            ::device_has_astc = pdd.physical_device_features_.textureCompressionASTC_LDR == VK_TRUE;
-            ::device_has_bc = pdd.physical_device_features_.textureCompressionBC == VK_TRUE;
-            ::device_has_etc2 = pdd.physical_device_features_.textureCompressionETC2 == VK_TRUE;
-
-            if (layer_settings->simulate.capabilities & SIMULATE_FORMATS_BIT) {
-                LoadDeviceFormats(instance, &pdd, physical_device, &pdd.device_formats_, &pdd.device_formats_3_);
+            if (pdd.physical_device_features_.textureCompressionASTC_LDR == VK_TRUE) {
+                pdd.device_texture_compression_ |= TEXTURE_COMPRESSION_ASTC_LDR_BIT;
+            }
+            if (pdd.physical_device_features_.textureCompressionBC == VK_TRUE) {
+                pdd.device_texture_compression_ |= TEXTURE_COMPRESSION_BC_BIT;
             }
+            if (pdd.physical_device_features_.textureCompressionETC2 == VK_TRUE) {
+                pdd.device_texture_compression_ |= TEXTURE_COMPRESSION_ETC2_BIT;
+            }
+
             if (layer_settings->simulate.capabilities & SIMULATE_QUEUE_FAMILY_PROPERTIES_BIT) {
                 LoadQueueFamilyProperties(instance, physical_device, &pdd);
             }
-            if (layer_settings->simulate.capabilities & (SIMULATE_VIDEO_CAPABILITIES_BIT | SIMULATE_VIDEO_FORMATS_BIT)) {
-                LoadVideoProfiles(instance, physical_device, &pdd, layer_settings->simulate.capabilities);
-            }
 
             LogMessage(layer_settings, DEBUG_REPORT_NOTIFICATION_BIT,
                        "Found \\"%s\\" with Vulkan %d.%d.%d driver.\\n", pdd.physical_device_properties_.deviceName,
@@ -3421,10 +3947,36 @@ ENUMERATE_PHYSICAL_DEVICES_END = '''
                 pdd.simulation_extensions_ = pdd.device_extensions_;
             }
 
-            for (std::size_t j = 0, m = layer_settings->simulate.exclude_device_extensions.size(); j < m; ++j) {
-                pdd.simulation_extensions_.erase(layer_settings->simulate.exclude_device_extensions[j].c_str());
+            const JsonLoader &json_loader = *JsonLoader::Find(instance);
+            for (const auto &extension : json_loader.GetExcludedExtensions()) {
+                pdd.simulation_extensions_.erase(extension);
+            }
+            pdd.excluded_formats_ = json_loader.GetExcludedFormats();
+
+            BuildPNextFillPlan(&pdd);
+
+            // The profile formats are answered from the PDD, the device properties are only needed once
+            for (const auto &format_properties : pdd.map_of_format_properties_) {
+                const VkFormat format = format_properties.first;
+                pdd.LoadDeviceFormat(format);
+
+                const VkFormatProperties &device_format = pdd.device_formats_[format];
+                const VkFormatProperties &profile_format = format_properties.second;
+                if ((layer_settings->simulate.capabilities & SIMULATE_FORMATS_BIT) && IsFormatSupported(profile_format)) {
+                    if (!HasFlags(device_format.linearTilingFeatures, profile_format.linearTilingFeatures) ||
+                        !HasFlags(device_format.optimalTilingFeatures, profile_format.optimalTilingFeatures) ||
+                        !HasFlags(device_format.bufferFeatures, profile_format.bufferFeatures)) {
+                        if (IsLogEnabled(layer_settings, DEBUG_REPORT_WARNING_BIT)) {
+                            LogMessage(layer_settings, DEBUG_REPORT_WARNING_BIT,
+                                       "format %s is simulating unsupported features!\\n", vkFormatToString(format).c_str());
+                        }
+                    }
+                }
             }
         }
+
+        // The new PDDs are fully populated, from now on they are only read
+        PhysicalDeviceData::Publish();
     }
 
     LogFlush(layer_settings);
@@ -3433,44 +3985,50 @@ ENUMERATE_PHYSICAL_DEVICES_END = '''
 }
 '''
 
-GET_INSTANCE_PROC_ADDR = '''
+LAYER_FUNCTIONS = [
+    'GetInstanceProcAddr',
+    'CreateInstance',
+    'EnumerateInstanceLayerProperties',
+    'EnumerateInstanceExtensionProperties',
+    'EnumerateDeviceExtensionProperties',
+    'EnumeratePhysicalDevices',
+    'DestroyInstance',
+    'GetPhysicalDeviceProperties',
+    'GetPhysicalDeviceProperties2',
+    'GetPhysicalDeviceProperties2KHR',
+    'GetPhysicalDeviceFeatures',
+    'GetPhysicalDeviceFeatures2',
+    'GetPhysicalDeviceFeatures2KHR',
+    'GetPhysicalDeviceFormatProperties',
+    'GetPhysicalDeviceFormatProperties2',
+    'GetPhysicalDeviceFormatProperties2KHR',
+    'GetPhysicalDeviceImageFormatProperties',
+    'GetPhysicalDeviceImageFormatProperties2',
+    'GetPhysicalDeviceImageFormatProperties2KHR',
+    'GetPhysicalDeviceToolProperties',
+    'GetPhysicalDeviceToolPropertiesEXT',
+    'GetPhysicalDeviceQueueFamilyProperties',
+    'GetPhysicalDeviceQueueFamilyProperties2',
+    'GetPhysicalDeviceQueueFamilyProperties2KHR',
+    'GetPhysicalDeviceVideoCapabilitiesKHR',
+    'GetPhysicalDeviceVideoFormatPropertiesKHR',
+]
+
+GET_INSTANCE_PROC_ADDR_BEGIN = '''
 VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetInstanceProcAddr(VkInstance instance, const char *pName) {
-// Apply the DRY principle, see https://en.wikipedia.org/wiki/Don%27t_repeat_yourself
-#define GET_PROC_ADDR(func) \\
-    if (strcmp("vk" #func, pName) == 0) return reinterpret_cast<PFN_vkVoidFunction>(func);
-    GET_PROC_ADDR(GetInstanceProcAddr);
-    GET_PROC_ADDR(CreateInstance);
-    GET_PROC_ADDR(EnumerateInstanceLayerProperties);
-    GET_PROC_ADDR(EnumerateInstanceExtensionProperties);
-    GET_PROC_ADDR(EnumerateDeviceExtensionProperties);
-    GET_PROC_ADDR(EnumeratePhysicalDevices);
-    GET_PROC_ADDR(DestroyInstance);
-    GET_PROC_ADDR(GetPhysicalDeviceProperties);
-    GET_PROC_ADDR(GetPhysicalDeviceProperties2);
-    GET_PROC_ADDR(GetPhysicalDeviceProperties2KHR);
-    GET_PROC_ADDR(GetPhysicalDeviceFeatures);
-    GET_PROC_ADDR(GetPhysicalDeviceFeatures2);
-    GET_PROC_ADDR(GetPhysicalDeviceFeatures2KHR);
-    GET_PROC_ADDR(GetPhysicalDeviceFormatProperties);
-    GET_PROC_ADDR(GetPhysicalDeviceFormatProperties2);
-    GET_PROC_ADDR(GetPhysicalDeviceFormatProperties2KHR);
-    GET_PROC_ADDR(GetPhysicalDeviceImageFormatProperties);
-    GET_PROC_ADDR(GetPhysicalDeviceImageFormatProperties2);
-    GET_PROC_ADDR(GetPhysicalDeviceImageFormatProperties2KHR);
-    GET_PROC_ADDR(GetPhysicalDeviceToolProperties);
-    GET_PROC_ADDR(GetPhysicalDeviceToolPropertiesEXT);
-    GET_PROC_ADDR(GetPhysicalDeviceQueueFamilyProperties);
-    GET_PROC_ADDR(GetPhysicalDeviceQueueFamilyProperties2);
-    GET_PROC_ADDR(GetPhysicalDeviceQueueFamilyProperties2KHR);
-    GET_PROC_ADDR(GetPhysicalDeviceVideoCapabilitiesKHR);
-    GET_PROC_ADDR(GetPhysicalDeviceVideoFormatPropertiesKHR);
-#undef GET_PROC_ADDR
+    // Functions intercepted by the layer, resolved without taking any lock
+'''
+
+GET_INSTANCE_PROC_ADDR_END = '''    const PFN_vkVoidFunction *layer_function = FindStringTableEntry(seeds, entries, pName);
+    if (layer_function != nullptr) {
+        return *layer_function;
+    }
 
     if (!instance) {
         return nullptr;
     }
 
-    std::lock_guard<std::recursive_mutex> lock(global_lock);
+    std::shared_lock<std::shared_mutex> lock(instance_lock);
     const auto dt = instance_dispatch_table(instance);
 
     if (!dt->GetInstanceProcAddr) {
@@ -3613,11 +4171,10 @@ class VulkanProfilesLayerGenerator():
             f.write(TRANSFER_DEFINES_ARRAY)
             f.write(self.generate_transfer_values())
             f.write(TRANSFER_UNDEFINE)
-            f.write(self.generate_load_device_formats())
             f.write(LOAD_QUEUE_FAMILY_PROPERTIES)
             f.write(LOAD_VIDEO_PROFILES)
             f.write(self.generate_enumerate_physical_device())
-            f.write(GET_INSTANCE_PROC_ADDR)
+            f.write(self.generate_get_instance_proc_addr())
 
     def struct_or_extension_platform(self, struct_or_ext_name):
         if struct_or_ext_name is None:
@@ -3670,7 +4227,8 @@ class VulkanProfilesLayerGenerator():
         return gen
 
     def generate_helpers(self):
-        gen = self.generate_string_to_enum('SimulateCapabilityFlags', ('SIMULATE_API_VERSION_BIT', 'SIMULATE_FEATURES_BIT', 'SIMULATE_PROPERTIES_BIT', 'SIMULATE_EXTENSIONS_BIT', 'SIMULATE_FORMATS_BIT', 'SIMULATE_QUEUE_FAMILY_PROPERTIES_BIT', 'SIMULATE_VIDEO_CAPABILITIES_BIT', 'SIMULATE_VIDEO_FORMATS_BIT', 'SIMULATE_MAX_ENUM'))
+        gen = STRING_TABLE_FUNCTIONS
+        gen += self.generate_string_to_enum('SimulateCapabilityFlags', ('SIMULATE_API_VERSION_BIT', 'SIMULATE_FEATURES_BIT', 'SIMULATE_PROPERTIES_BIT', 'SIMULATE_EXTENSIONS_BIT', 'SIMULATE_FORMATS_BIT', 'SIMULATE_QUEUE_FAMILY_PROPERTIES_BIT', 'SIMULATE_VIDEO_CAPABILITIES_BIT', 'SIMULATE_VIDEO_FORMATS_BIT', 'SIMULATE_MAX_ENUM'))
         gen += self.generate_enum_to_string('SimulateCapabilityFlags', ('SIMULATE_API_VERSION_BIT', 'SIMULATE_FEATURES_BIT', 'SIMULATE_PROPERTIES_BIT', 'SIMULATE_EXTENSIONS_BIT', 'SIMULATE_FORMATS_BIT', 'SIMULATE_QUEUE_FAMILY_PROPERTIES_BIT', 'SIMULATE_VIDEO_CAPABILITIES_BIT', 'SIMULATE_VIDEO_FORMATS_BIT'), 'GetSimulateCapabilitiesLog')
         gen += self.generate_enum_to_string('DebugActionFlags', ('DEBUG_REPORT_NOTIFICATION_BIT', 'DEBUG_REPORT_WARNING_BIT', 'DEBUG_REPORT_ERROR_BIT', 'DEBUG_REPORT_DEBUG_BIT'), 'GetDebugReportsLog')
 
@@ -5150,45 +5708,48 @@ class VulkanProfilesLayerGenerator():
         return gen
 
     def generate_fill_physical_device_pnext_chain(self):
-        gen = '\nvoid FillPNextChain(PhysicalDeviceData *physicalDeviceData, void *place) {\n'
-        gen += '    ProfileLayerSettings *layer_settings = &JsonLoader::Find(physicalDeviceData->instance())->layer_settings;\n'
-        gen += '    while (place) {\n'
-        gen += '        VkBaseOutStructure *structure = (VkBaseOutStructure *)place;\n\n'
-        gen += '        // These switch statements check which struct is in the pNext chain and, if the physical device has the proper extension,\n'
-        gen += '        // fill the struct with any override data provided by the PhysicalDeviceData object.\n\n'
-        gen += '        switch (structure->sType) {\n'
-        gen += '            // VK_KHR_portability_subset is a special case since it can also be emulated by the Profiles layer.\n'
-        gen += '            case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PORTABILITY_SUBSET_PROPERTIES_KHR:\n'
-        gen += '                if (PhysicalDeviceData::HasSimulatedExtension(physicalDeviceData, VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME) ||\n'
-        gen += '                    layer_settings->simulate.emulate_portability) {\n'
-        gen += '                    VkPhysicalDevicePortabilitySubsetPropertiesKHR *psp = (VkPhysicalDevicePortabilitySubsetPropertiesKHR *)place;\n'
-        gen += '                    void *pNext = psp->pNext;\n'
-        gen += '                    *psp = physicalDeviceData->physical_device_portability_subset_properties_;\n'
-        gen += '                    if (layer_settings->portability.vertexAttributeAccessBeyondStride) {\n'
-        gen += '                        psp->minVertexInputBindingStrideAlignment = layer_settings->portability.minVertexInputBindingStrideAlignment;\n'
-        gen += '                    }\n'
-        gen += '                    psp->pNext = pNext;\n'
-        gen += '                }\n'
-        gen += '                break;\n'
+        gen = '\nvoid BuildPNextFillPlan(PhysicalDeviceData *physicalDeviceData) {\n'
+        gen += '    ProfileLayerSettings *layer_settings = physicalDeviceData->layer_settings();\n'
+        gen += '    auto &plan = physicalDeviceData->pnext_fill_plan_;\n\n'
+        gen += '    // VK_KHR_portability_subset is a special case since it can also be emulated by the Profiles layer.\n'
+        gen += '    if (PhysicalDeviceData::HasSimulatedExtension(physicalDeviceData, VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME) ||\n'
+        gen += '        layer_settings->simulate.emulate_portability) {\n'
+        gen += '        VkPhysicalDevicePortabilitySubsetPropertiesKHR &psp = physicalDeviceData->emulated_portability_subset_properties_;\n'
+        gen += '        psp = physicalDeviceData->physical_device_portability_subset_properties_;\n'
+        gen += '        if (layer_settings->portability.vertexAttributeAccessBeyondStride) {\n'
+        gen += '            psp.minVertexInputBindingStrideAlignment = layer_settings->portability.minVertexInputBindingStrideAlignment;\n'
+        gen += '        }\n'
+        gen += '        plan[VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PORTABILITY_SUBSET_PROPERTIES_KHR] = {&psp, sizeof(psp)};\n'
+        gen += '    }\n'
 
         for property in self.non_extension_properties:
-            gen += self.generate_fill_case(property)
+            gen += self.generate_fill_plan_entry(property)
         for feature in self.non_extension_features:
-            gen += self.generate_fill_case(feature)
+            gen += self.generate_fill_plan_entry(feature)
         for ext, properties, features in self.extension_structs:
             gen += self.generate_platform_protect_begin(ext)
             for property in properties:
                 # exception, already handled above
                 if property == 'VkPhysicalDevicePortabilitySubsetPropertiesKHR':
                     continue
-                gen += self.generate_fill_case(property)
+                gen += self.generate_fill_plan_entry(property)
             for feature in features:
-                gen += self.generate_fill_case(feature)
+                gen += self.generate_fill_plan_entry(feature)
             gen += self.generate_platform_protect_end(ext)
+        gen += '}\n'
 
-        gen += '            default:\n'
-        gen += '                break;\n'
-
+        gen += '\nvoid FillPNextChain(const PhysicalDeviceData *physicalDeviceData, void *place) {\n'
+        gen += '    if (physicalDeviceData == nullptr) {\n'
+        gen += '        return;\n'
+        gen += '    }\n\n'
+        gen += '    while (place) {\n'
+        gen += '        VkBaseOutStructure *structure = (VkBaseOutStructure *)place;\n\n'
+        gen += '        // The plan only holds the structures supported by the physical device, copy their emulated values.\n'
+        gen += '        const auto entry = physicalDeviceData->pnext_fill_plan_.find(structure->sType);\n'
+        gen += '        if (entry != physicalDeviceData->pnext_fill_plan_.end()) {\n'
+        gen += '            VkBaseOutStructure *pNext = structure->pNext;\n'
+        gen += '            std::memcpy(place, entry->second.data, entry->second.size);\n'
+        gen += '            structure->pNext = pNext;\n'
         gen += '        }\n\n'
         gen += '        place = structure->pNext;\n'
         gen += '    }\n'
@@ -5197,7 +5758,7 @@ class VulkanProfilesLayerGenerator():
         return gen
 
     def generate_fill_queue_family_properties_pnext_chain(self):
-        gen = '\nvoid FillQueueFamilyPropertiesPNextChain(PhysicalDeviceData *physicalDeviceData, VkQueueFamilyProperties2KHR *pQueueFamilyProperties2, uint32_t count) {\n'
+        gen = '\nvoid FillQueueFamilyPropertiesPNextChain(const PhysicalDeviceData *physicalDeviceData, VkQueueFamilyProperties2KHR *pQueueFamilyProperties2, uint32_t count) {\n'
         gen += '    for (uint32_t i = 0; i < count; ++i) {\n'
         gen += '        void* place = pQueueFamilyProperties2[i].pNext;\n'
         gen += '        while (place) {\n'
@@ -5261,33 +5822,6 @@ class VulkanProfilesLayerGenerator():
 
         return gen
 
-    def generate_load_device_formats(self):
-        gen = '\nvoid LoadDeviceFormats(VkInstance instance, PhysicalDeviceData *pdd, VkPhysicalDevice pd, MapOfVkFormatProperties *dest,\n'
-        gen += '                       MapOfVkFormatProperties3 *dest3) {\n'
-        gen += '    std::vector<VkFormat> formats = {\n'
-        a = self.registry.enums['VkFormat']
-        for format in self.registry.enums['VkFormat'].values:
-            if format not in self.registry.enums['VkFormat'].aliasValues:
-                gen += '        ' + format + ',\n'
-        gen += '    };\n'
-        gen += '    const auto dt = instance_dispatch_table(instance);\n'
-        gen += '    for (const auto format : formats) {\n'
-        gen += '        VkFormatProperties3KHR format_properties_3 = {};\n'
-        gen += '        format_properties_3.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3_KHR;\n\n'
-        gen += '        VkFormatProperties2 format_properties = {};\n'
-        gen += '        format_properties.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;\n'
-        gen += '        format_properties.pNext = &format_properties_3;\n\n'
-        gen += '        if (pdd->GetEffectiveVersion() >= VK_API_VERSION_1_1) {\n'
-        gen += '            dt->GetPhysicalDeviceFormatProperties2(pd, format, &format_properties);\n'
-        gen += '        } else {\n'
-        gen += '            dt->GetPhysicalDeviceFormatProperties2KHR(pd, format, &format_properties);\n'
-        gen += '        }\n'
-        gen += '        (*dest)[format] = format_properties.formatProperties;\n'
-        gen += '        (*dest3)[format] = format_properties_3;\n'
-        gen += '    }\n'
-        gen += '}\n'
-        return gen
-
     def generate_enumerate_physical_device(self):
         gen = ENUMERATE_PHYSICAL_DEVICES_BEGIN
 
@@ -5384,119 +5918,137 @@ class VulkanProfilesLayerGenerator():
         gen += '}\n'
         return gen
 
-    def generate_fill_case(self, struct):
+    def generate_fill_plan_entry(self, struct):
         structure = self.registry.structs[struct]
         if structure.name in self.ignored_structs:
             return ''
-        gen = '            case ' + structure.sType + ':\n'
-        gen += '                '
+        condition = None
         if structure.definedByExtensions:
-            gen += 'if ('
+            condition = ''
             first = True
             for ext in structure.definedByExtensions:
                 if first:
                     first = False
                 else:
-                    gen += ' && '
+                    condition += ' && '
                 for promotedTo in [ext] + self.registry.getExtensionPromotedToExtensionList(ext):
                     if promotedTo != ext:
-                        gen += ' || '
+                        condition += ' || '
                     else:
-                        gen += '('
-                    gen += 'PhysicalDeviceData::HasSimulatedExtension(physicalDeviceData, '
-                    gen += self.registry.extensions[promotedTo].upperCaseName + '_EXTENSION_NAME'
-                    gen += ')'
-                gen += ')'
-            gen += ') '
+                        condition += '('
+                    condition += 'PhysicalDeviceData::HasSimulatedExtension(physicalDeviceData, '
+                    condition += self.registry.extensions[promotedTo].upperCaseName + '_EXTENSION_NAME'
+                    condition += ')'
+                condition += ')'
         elif structure.definedByVersion and (structure.definedByVersion.major != 1 or structure.definedByVersion.minor != 0):
-            gen += 'if (physicalDeviceData->GetEffectiveVersion() >= ' + structure.definedByVersion.versionMacro + ') '
-        gen += '{\n'
-        gen += '                    ' + structure.name + ' *data = (' + structure.name + ' *)place;\n'
-        if structure.name in self.broken_pnext_structs:
-            gen += '                    void *pNext = const_cast<void*>(data->pNext);\n'
-        else:
-            gen += '                    void *pNext = data->pNext;\n'
-        gen += '                    *data = physicalDeviceData->' + self.create_var_name(structure.name) + ';\n'
-        gen += '                    data->pNext = pNext;\n'
-        gen += '                }\n'
-        gen += '                break;\n'
+            condition = 'physicalDeviceData->GetEffectiveVersion() >= ' + structure.definedByVersion.versionMacro
+
+        member = 'physicalDeviceData->' + self.create_var_name(structure.name)
+        entry = 'plan[' + structure.sType + '] = {&' + member + ', sizeof(' + structure.name + ')};\n'
+        if condition is None:
+            return '    ' + entry
+        gen = '    if (' + condition + ') {\n'
+        gen += '        ' + entry
+        gen += '    }\n'
         return gen
 
+    def generate_get_value_member(self, structure, member_name):
+        member = self.registry.structs[structure].members[member_name]
+        not_modifiable = str((member.limittype == 'exact' or member.limittype == 'noauto') and not member.isDynamicallySizedArrayWithCap()).lower()
+        if member.isArray:
+            return ('GetArray(device_name, parent, member, "' + member_name + '", dest->' + member_name + ', ' +
+                    ('&dest->' + member.arraySizeMember + ', ' if member.isDynamicallySizedArrayWithCap() else '') + not_modifiable + ');')
+        elif member.type in self.registry.enums:
+            return 'GET_VALUE_ENUM_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqualEnum);'
+        elif member.type == 'VkConformanceVersion' or member.type == 'VkToolPurposeFlags':
+            return None
+        elif member.type == 'VkBool32':
+            return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqualBool);'
+        elif member.type == 'size_t':
+            if 'min' in member.limittype:
+                return 'GET_VALUE_SIZE_T_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesserSizet);'
+            elif 'max' in member.limittype or 'bits' in member.limittype:
+                return 'GET_VALUE_SIZE_T_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreaterSizet);'
+            #elif member.limittype == 'pot':
+            else:
+                return 'GET_VALUE_SIZE_T_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqualSizet);'
+        elif member.type == 'uint64_t' or member.type == 'int32_t' or member.type == 'VkDeviceSize':
+            if 'min' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);'
+            elif 'max' in member.limittype or 'bits' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);'
+            else:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqual64u);'
+        elif member.type == 'int64_t':
+            if 'min' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);'
+            elif 'max' in member.limittype or 'bits' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);'
+            else:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEquali64);'
+        elif member.type == 'uint32_t':
+            if 'min' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);'
+            elif 'max' in member.limittype or 'bits' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);'
+            else:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqual32u);'
+        elif member.type == 'VkExtent2D' or member.type == 'VkExtent3D':
+            if 'min' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);'
+            elif 'max' in member.limittype or 'bits' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);'
+            else:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqual32u);'
+        elif member.type == 'float':
+            if 'min' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesserFloat);'
+            elif 'max' in member.limittype:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreaterFloat);'
+            else:
+                return 'GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqualFloat);'
+        elif member.limittype == 'bitmask':
+            return 'GET_VALUE_FLAG_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile);'
+        elif member.limittype == 'min': # enum values
+            return 'GET_VALUE_ENUM_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);'
+        elif member.limittype == 'max' or member.limittype == 'bits': # enum values
+            return 'GET_VALUE_ENUM_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);'
+        else:
+            print("ERROR: Unsupported limittype '{0}' in member '{1}' of structure '{2}'".format(member.limittype, member_name, structure))
+            return None
+
     def generate_get_value_function(self, structure):
         if (structure in self.ignored_structs):
             return ''
+
+        reads = []
+        for member_name in self.registry.structs[structure].members:
+            read = self.generate_get_value_member(structure, member_name)
+            if read is not None:
+                reads.append((member_name, read))
+
         gen = self.generate_platform_protect_begin(structure)
         gen += 'bool JsonLoader::GetStruct(const char* device_name, bool requested_profile, const Json::Value &parent, ' + structure + ' *dest) {\n'
         gen += '    (void)dest;\n'
         gen += '    (void)requested_profile;\n'
         gen += '    LogMessage(&layer_settings, DEBUG_REPORT_DEBUG_BIT, \"\\tJsonLoader::GetStruct(' + structure + ')\\n\");\n'
         gen += '    bool valid = true;\n'
-        gen += '    for (const auto &member : parent.getMemberNames()) {\n'
-        for member_name in self.registry.structs[structure].members:
-            member = self.registry.structs[structure].members[member_name]
-            not_modifiable = str((member.limittype == 'exact' or member.limittype == 'noauto') and not member.isDynamicallySizedArrayWithCap()).lower()
-            if member.isArray:
-                gen += ('        GetArray(device_name, parent, member, "' + member_name + '", dest->' + member_name + ', ' +
-                        ('&dest->' + member.arraySizeMember + ', ' if member.isDynamicallySizedArrayWithCap() else '') + not_modifiable + ');\n')
-            elif member.type in self.registry.enums:
-                gen += '        GET_VALUE_ENUM_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqualEnum);\n'
-            elif member.type == 'VkConformanceVersion' or member.type == 'VkToolPurposeFlags':
-                continue
-            elif member.type == 'VkBool32':
-                gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqualBool);\n'
-            elif member.type == 'size_t':
-                if 'min' in member.limittype:
-                    gen += '        GET_VALUE_SIZE_T_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesserSizet);\n'
-                elif 'max' in member.limittype or 'bits' in member.limittype:
-                    gen += '        GET_VALUE_SIZE_T_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreaterSizet);\n'
-                #elif member.limittype == 'pot':
-                else:
-                    gen += '        GET_VALUE_SIZE_T_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqualSizet);\n'
-            elif member.type == 'uint64_t' or member.type == 'int32_t' or member.type == 'VkDeviceSize':
-                if 'min' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);\n'
-                elif 'max' in member.limittype or 'bits' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);\n'
-                else:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqual64u);\n'
-            elif member.type == 'int64_t':
-                if 'min' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);\n'
-                elif 'max' in member.limittype or 'bits' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);\n'
-                else:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEquali64);\n'
-            elif member.type == 'uint32_t':
-                if 'min' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);\n'
-                elif 'max' in member.limittype or 'bits' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);\n'
-                else:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqual32u);\n'
-            elif member.type == 'VkExtent2D' or member.type == 'VkExtent3D':
-                if 'min' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);\n'
-                elif 'max' in member.limittype or 'bits' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);\n'
-                else:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqual32u);\n'
-            elif member.type == 'float':
-                if 'min' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesserFloat);\n'
-                elif 'max' in member.limittype:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreaterFloat);\n'
-                else:
-                    gen += '        GET_VALUE_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfNotEqualFloat);\n'
-            elif member.limittype == 'bitmask':
-                gen += '        GET_VALUE_FLAG_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile);\n'
-            elif member.limittype == 'min': # enum values
-                gen += '        GET_VALUE_ENUM_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfLesser);\n'
-            elif member.limittype == 'max' or member.limittype == 'bits': # enum values
-                gen += '        GET_VALUE_ENUM_WARN(member, ' + member_name + ', ' + not_modifiable + ', requested_profile, WarnIfGreater);\n'
-            else:
-                print("ERROR: Unsupported limittype '{0}' in member '{1}' of structure '{2}'".format(member.limittype, member_name, structure))
-
-        gen += '    }\n'
+        if reads:
+            # Member names sorted for FindJsonMember, each associated with the case reading the member
+            gen += '    static const JsonMember members[] = {\n'
+            for member_name, case in sorted((member_name, case) for case, (member_name, read) in enumerate(reads)):
+                gen += '        {"' + member_name + '", ' + str(case) + '},\n'
+            gen += '    };\n'
+            gen += '    for (const auto &member : parent.getMemberNames()) {\n'
+            gen += '        switch (FindJsonMember(members, member)) {\n'
+            for case, (member_name, read) in enumerate(reads):
+                gen += '            case ' + str(case) + ':\n'
+                gen += '                ' + read + '\n'
+                gen += '                break;\n'
+            gen += '            default:\n'
+            gen += '                break;\n'
+            gen += '        }\n'
+            gen += '    }\n'
         gen += '    return valid;\n'
         gen += '}\n\n'
         gen += self.generate_platform_protect_end(structure)
@@ -5688,21 +6240,88 @@ class VulkanProfilesLayerGenerator():
                 ret.append(el)
         return ret
 
+    def hash_string(self, string, seed):
+        # Must match HashString in the generated layer
+        hash = ((2166136261 ^ seed) * 16777619) & 0xFFFFFFFF
+        for byte in string.encode():
+            hash ^= byte
+            hash = (hash * 16777619) & 0xFFFFFFFF
+        return hash
+
+    def generate_perfect_hash(self, names):
+        # Hash and displace: the names are distributed in buckets by the first hash, then each bucket, largest first,
+        # gets the seed of a second hash that places all its names in empty slots of the table.
+        slot_count = len(names)
+        while True:
+            bucket_count = max(1, (len(names) + 3) // 4)
+            buckets = [[] for i in range(bucket_count)]
+            for name in names:
+                buckets[self.hash_string(name, 0) % bucket_count].append(name)
+
+            seeds = [0] * bucket_count
+            slots = [None] * slot_count
+            complete = True
+            for bucket in sorted(range(bucket_count), key=lambda b: len(buckets[b]), reverse=True):
+                if not buckets[bucket]:
+                    break
+                for seed in range(1, 1 << 16):
+                    positions = [self.hash_string(name, seed) % slot_count for name in buckets[bucket]]
+                    if len(set(positions)) == len(positions) and all(slots[p] is None for p in positions):
+                        break
+                else:
+                    complete = False
+                    break
+                seeds[bucket] = seed
+                for name, position in zip(buckets[bucket], positions):
+                    slots[position] = name
+            if complete:
+                return seeds, slots
+            slot_count += 1
+
+    def generate_string_table_data(self, type, entries, default_value, storage = 'static constexpr'):
+        # entries: list of (name, value) where value is a C++ expression of the type of the table
+        values = {}
+        for name, value in entries:
+            if name not in values:
+                values[name] = value
+        seeds, slots = self.generate_perfect_hash(list(values.keys()))
+
+        gen = '    static constexpr uint32_t seeds[] = {'
+        for i, seed in enumerate(seeds):
+            gen += ('\n        ' if i % 16 == 0 else ' ') + str(seed) + ','
+        gen += '\n    };\n'
+        gen += '    ' + storage + ' StringTableEntry<' + type + '> entries[] = {\n'
+        for name in slots:
+            if name is None:
+                gen += '        {\"\", ' + default_value + '},\n'
+            else:
+                gen += '        {\"' + name + '\", ' + values[name] + '},\n'
+        gen += '    };\n'
+        return gen
+
+    def generate_string_table(self, type, entries, default_value):
+        gen = self.generate_string_table_data(type, entries, default_value)
+        gen += '    const ' + type + ' *value = FindStringTableEntry(seeds, entries, input_value);\n'
+        gen += '    return value != nullptr ? *value : ' + default_value + ';\n'
+        return gen
+
+    def generate_get_instance_proc_addr(self):
+        # The function pointers are not constant expressions, the table is initialized on the first call
+        entries = [('vk' + function, 'reinterpret_cast<PFN_vkVoidFunction>(' + function + ')') for function in LAYER_FUNCTIONS]
+        gen = GET_INSTANCE_PROC_ADDR_BEGIN
+        gen += self.generate_string_table_data('PFN_vkVoidFunction', entries, 'nullptr', 'static const')
+        gen += GET_INSTANCE_PROC_ADDR_END
+        return gen
+
     def generate_string_to_uint(self, lists, enums):
-        gen = '\nstatic uint64_t VkStringToUint64(const std::string &input_value) {\n'
-        gen += '    static const std::unordered_map<std::string, uint64_t> map = {\n'
-        for list in lists:
+        gen = '\nstatic uint64_t VkStringToUint64(std::string_view input_value) {\n'
+        entries = []
+        for list in sorted(lists):
             if list not in enums:
                 continue
-            gen += '        // ' + list + '\n'
             for enum in enums[list].values:
-                gen += '        {\"' + enum + '\", static_cast<uint64_t>(' + enum + ')},\n'
-        gen += '    };\n'
-        gen += '    const auto it = map.find(input_value);\n'
-        gen += '    if (it != map.end()) {\n'
-        gen += '        return it->second;\n'
-        gen += '    }\n'
-        gen += '    return 0;\n'
+                entries.append((enum, 'static_cast<uint64_t>(' + enum + ')'))
+        gen += self.generate_string_table('uint64_t', entries, '0')
         gen += '}\n'
         return gen
 
@@ -5717,16 +6336,8 @@ class VulkanProfilesLayerGenerator():
         return gen
 
     def generate_string_to_flags(self, type, enums):
-        gen = '\nstatic ' + type + ' StringTo' + type + '(const std::string &input_value) {\n'
-        gen += '    static const std::unordered_map<std::string, ' + type + '> map = {\n'
-        for enum in enums.values:
-            gen += '        {\"' + enum + '\", ' + enum + '},\n'
-        gen += '    };\n'
-        gen += '    const auto it = map.find(input_value);\n'
-        gen += '    if (it != map.end()) {\n'
-        gen += '        return it->second;\n'
-        gen += '    }\n'
-        gen += '    return ' + type + '{};\n'
+        gen = '\nstatic ' + type + ' StringTo' + type + '(std::string_view input_value) {\n'
+        gen += self.generate_string_table(type, [(enum, enum) for enum in enums.values], type + '{}')
         gen += '}\n'
         return gen
 
@@ -5781,30 +6392,14 @@ class VulkanProfilesLayerGenerator():
         return gen
 
     def generate_string_to_format(self, formats):
-        gen = '\nstatic VkFormat StringToFormat(const std::string &input_value) {\n'
-        gen += '    static const std::unordered_map<std::string, VkFormat> map = {\n'
-        for format in formats:
-            gen += '        {\"' + format + '\", ' + format + '},\n'
-        gen += '    };\n'
-        gen += '    const auto it = map.find(input_value);\n'
-        gen += '    if (it != map.end()) {\n'
-        gen += '        return it->second;\n'
-        gen += '    }\n'
-        gen += '    return VK_FORMAT_UNDEFINED;\n'
+        gen = '\nstatic VkFormat StringToFormat(std::string_view input_value) {\n'
+        gen += self.generate_string_table('VkFormat', [(format, format) for format in formats], 'VK_FORMAT_UNDEFINED')
         gen += '}\n'
         return gen
 
     def generate_string_to_image_layout(self, imageLayouts):
-        gen = '\nstatic VkImageLayout StringToImageLayout(const std::string &input_value) {\n'
-        gen += '    static const std::unordered_map<std::string, VkImageLayout> map = {\n'
-        for imageLayout in imageLayouts:
-            gen += '        {\"' + imageLayout + '\", ' + imageLayout + '},\n'
-        gen += '    };\n'
-        gen += '    const auto it = map.find(input_value);\n'
-        gen += '    if (it != map.end()) {\n'
-        gen += '        return it->second;\n'
-        gen += '    }\n'
-        gen += '    return VK_IMAGE_LAYOUT_UNDEFINED;\n'
+        gen = '\nstatic VkImageLayout StringToImageLayout(std::string_view input_value) {\n'
+        gen += self.generate_string_table('VkImageLayout', [(imageLayout, imageLayout) for imageLayout in imageLayouts], 'VK_IMAGE_LAYOUT_UNDEFINED')
         gen += '}\n'
         return gen
 
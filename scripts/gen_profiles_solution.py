@@ -29,7 +29,6 @@ from typing import OrderedDict
 import xml.etree.ElementTree as etree
 import json
 from collections import deque
-from string import Template
 
 def apiNameMatch(str, supported):
     """Return whether a required api name matches a pattern specified for an
@@ -155,6 +154,11 @@ SHARED_INCLUDE = '''
 #include <algorithm>
 #include <memory>
 #include <map>
+#include <mutex>
+#ifdef VP_USE_THREADS
+#include <system_error>
+#include <thread>
+#endif//VP_USE_THREADS
 '''
 
 API_DEFS = '''
@@ -214,6 +218,20 @@ VK_DEFINE_HANDLE(VpFunctions)
 
 typedef VpFunctions VpCapabilities;
 
+VK_DEFINE_HANDLE(VpPhysicalDeviceSnapshot)
+
+typedef enum VpPhysicalDeviceRankingFlagBits {
+    VP_PHYSICAL_DEVICE_RANKING_PARALLEL_BIT = 0x0000001,
+    VP_PHYSICAL_DEVICE_RANKING_FLAG_BITS_MAX_ENUM = 0x7FFFFFFF
+} VpPhysicalDeviceRankingFlagBits;
+typedef VkFlags VpPhysicalDeviceRankingFlags;
+
+typedef struct VpPhysicalDeviceRanking {
+    VkPhysicalDevice    physicalDevice;
+    uint32_t            firstSupportedProfileIndex;
+    uint32_t            supportedProfileCount;
+} VpPhysicalDeviceRanking;
+
 typedef enum VpFunctionsCreateFlagBits {
     VP_FUNCTIONS_CREATE_FLAG_BITS_MAX_ENUM = 0x7FFFFFFF
 } VpFunctionsCreateFlagBits;
@@ -274,6 +292,10 @@ struct VpFunctions_T {
     PFN_vkCreateInstance CreateInstance = nullptr;
     PFN_vkCreateDevice CreateDevice = nullptr;
 
+    // Physical device snapshots created with these functions, see vpCreatePhysicalDeviceSnapshot. The list is modified
+    // without a lock, the creation and destruction of the snapshots are externally synchronized with the other calls.
+    VpPhysicalDeviceSnapshot pSnapshots = nullptr;
+
 private:
 #ifndef VK_NO_PROTOTYPES
     void ImportVulkanFunctions_Static() {
@@ -438,6 +460,56 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
     uint32_t*                                   pPropertyCount,
     VpBlockProperties*                          pProperties);
 
+// Check which profiles of a list are supported by the physical device, the driver queries are shared by the profiles.
+// pSupported is an array of profileCount elements, the blocks not supported by the unsupported profiles are reported
+// to pProperties, each block identifies its profile. pPropertyCount may be NULL when the blocks are not needed.
+VPAPI_ATTR VkResult vpGetPhysicalDeviceProfilesSupport(
+#ifdef VP_USE_OBJECT
+    VpFunctions                                 functions,
+#endif//VP_USE_OBJECT
+    VkInstance                                  instance,
+    VkPhysicalDevice                            physicalDevice,
+    uint32_t                                    profileCount,
+    const VpProfileProperties*                  pProfiles,
+    VkBool32*                                   pSupported,
+    uint32_t*                                   pPropertyCount,
+    VpBlockProperties*                          pProperties);
+
+// Check a list of profiles on each physical device of the instance and rank the physical devices, the profiles are listed by
+// order of preference. pRankings is sorted from the best physical device. When VP_USE_THREADS is defined, with
+// VP_PHYSICAL_DEVICE_RANKING_PARALLEL_BIT each physical device is checked on its own thread and the debug message callback
+// may be called concurrently. Otherwise, or when built without C++ exceptions, VP_PHYSICAL_DEVICE_RANKING_PARALLEL_BIT is ignored.
+VPAPI_ATTR VkResult vpGetPhysicalDeviceRankings(
+#ifdef VP_USE_OBJECT
+    VpFunctions                                 functions,
+#endif//VP_USE_OBJECT
+    VkInstance                                  instance,
+    uint32_t                                    profileCount,
+    const VpProfileProperties*                  pProfiles,
+    VpPhysicalDeviceRankingFlags                flags,
+    uint32_t*                                   pRankingCount,
+    VpPhysicalDeviceRanking*                    pRankings);
+
+// Capture the capabilities of a physical device. Until the snapshot is invalidated or destroyed, the physical device
+// support queries using the same functions reuse the captured capabilities instead of querying the driver again.
+// Creating or destroying a snapshot must be externally synchronized with any other call using the same functions.
+VPAPI_ATTR VkResult vpCreatePhysicalDeviceSnapshot(
+#ifdef VP_USE_OBJECT
+    VpFunctions                                 functions,
+#endif//VP_USE_OBJECT
+    VkPhysicalDevice                            physicalDevice,
+    VpPhysicalDeviceSnapshot*                   pSnapshot);
+
+// Discard the captured capabilities of a physical device, they are captured again by the next support query. The
+// snapshot may be invalidated while support queries use it: the running queries keep the capabilities they started with.
+VPAPI_ATTR void vpInvalidatePhysicalDeviceSnapshot(
+    VpPhysicalDeviceSnapshot                    snapshot);
+
+// Destroy a physical device snapshot, the support queries of the physical device query the driver again. Destroying a
+// snapshot must be externally synchronized with every support query using it.
+VPAPI_ATTR void vpDestroyPhysicalDeviceSnapshot(
+    VpPhysicalDeviceSnapshot                    snapshot);
+
 // Create a VkDevice with the profile features and device extensions enabled
 VPAPI_ATTR VkResult vpCreateDevice(
 #ifdef VP_USE_OBJECT
@@ -848,24 +920,95 @@ struct VpProfileDesc {
 
     uint32_t                        fallbackCount;
     const VpProfileProperties*      pFallbacks;
+
+    // Variants of the required capabilities sorted by block name
+    uint32_t                        blockCount;
+    const VpVariantDesc* const*     ppBlocks;
+};
+
+// Variants of a profile with the same block name: a capability listed by several capability groups has one variant for each
+struct VpBlockVariants {
+    const VpVariantDesc* const* first = nullptr;
+    const VpVariantDesc* const* last = nullptr;
+
+    bool Contains(const VpVariantDesc* variant) const {
+        return std::find(first, last, variant) != last;
+    }
 };
 
 template <typename T>
 VPAPI_ATTR bool vpCheckFlags(const T& actual, const uint64_t expected) {
     return (actual & expected) == expected;
 }
+
+VPAPI_ATTR std::size_t vpGetStructureSize(VkStructureType type);
+
+// Structures returned by the driver, indexed by format or queue family index and by structure type
+class VpStructureStore {
+public:
+    // Copy the stored structures into the chain, fails when a structure of the chain was not stored
+    bool Load(uint32_t index, VkBaseOutStructure* p) const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (; p != nullptr; p = p->pNext) {
+            const auto it = this->structures.find(std::make_pair(index, p->sType));
+            if (it == this->structures.end()) {
+                return false;
+            }
+            memcpy(reinterpret_cast<uint8_t*>(p) + sizeof(VkBaseOutStructure), it->second.data(), it->second.size());
+        }
+        return true;
+    }
+
+    // Structures with pointers to application memory are not stored
+    void Store(uint32_t index, const VkBaseOutStructure* p) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (; p != nullptr; p = p->pNext) {
+            const std::size_t size = vpGetStructureSize(p->sType);
+            if (size == 0) {
+                continue;
+            }
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(p) + sizeof(VkBaseOutStructure);
+            this->structures[std::make_pair(index, p->sType)].assign(data, data + size - sizeof(VkBaseOutStructure));
+        }
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->structures.clear();
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::pair<uint32_t, VkStructureType>, std::vector<uint8_t>> structures;
+};
 '''
 
 PRIVATE_IMPL_BODY = '''
 VPAPI_ATTR const VpProfileDesc* vpGetProfileDesc(const char profileName[VP_MAX_PROFILE_NAME_SIZE]) {
-    for (uint32_t profileIndex = 0; profileIndex < profileCount; ++profileIndex) {
-        if (strncmp(profiles[profileIndex].props.profileName, profileName, VP_MAX_PROFILE_NAME_SIZE) == 0) {
-            return &profiles[profileIndex];
-        }
+    const VpProfileDesc* const end = profiles + profileCount;
+    const VpProfileDesc* it = std::lower_bound(profiles, end, profileName, [](const VpProfileDesc& desc, const char* name) {
+        return strncmp(desc.props.profileName, name, VP_MAX_PROFILE_NAME_SIZE) < 0;
+    });
+    if (it != end && strncmp(it->props.profileName, profileName, VP_MAX_PROFILE_NAME_SIZE) == 0) {
+        return it;
     }
     return nullptr;
 }
 
+VPAPI_ATTR VpBlockVariants vpGetBlockVariants(const VpProfileDesc& profileDesc, const char* pBlockName) {
+    struct BlockNameLess {
+        bool operator()(const VpVariantDesc* variant, const char* name) const {
+            return strncmp(variant->blockName, name, VP_MAX_PROFILE_NAME_SIZE) < 0;
+        }
+        bool operator()(const char* name, const VpVariantDesc* variant) const {
+            return strncmp(name, variant->blockName, VP_MAX_PROFILE_NAME_SIZE) < 0;
+        }
+    };
+
+    const auto range = std::equal_range(profileDesc.ppBlocks, profileDesc.ppBlocks + profileDesc.blockCount, pBlockName, BlockNameLess());
+    return VpBlockVariants{range.first, range.second};
+}
+
 VPAPI_ATTR std::vector<VpProfileProperties> GatherProfiles(const VpProfileProperties& profile, const char* pBlockName = nullptr) {
     std::vector<VpProfileProperties> gatheredProfiles;
 
@@ -1056,13 +1199,15 @@ VPAPI_ATTR VkResult vpGetProfileStructureTypes(
         const detail::VpProfileDesc* profile_desc = detail::vpGetProfileDesc(gathered_profiles[profile_index].profileName);
         if (profile_desc == nullptr) return VK_ERROR_UNKNOWN;
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*profile_desc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t capability_index = 0; capability_index < profile_desc->requiredCapabilityCount; ++capability_index) {
             const detail::VpCapabilitiesDesc& cap_desc = profile_desc->pRequiredCapabilities[capability_index];
 
             for (uint32_t variant_index = 0; variant_index < cap_desc.variantCount; ++variant_index) {
                 const detail::VpVariantDesc& variant = cap_desc.pVariants[variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -1158,13 +1303,15 @@ VPAPI_ATTR VkResult vpGetProfileExtensionProperties(
             return VK_ERROR_UNKNOWN;
         }
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*profile_desc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t capability_index = 0; capability_index < profile_desc->requiredCapabilityCount; ++capability_index) {
             const detail::VpCapabilitiesDesc& cap_desc = profile_desc->pRequiredCapabilities[capability_index];
 
             for (uint32_t variant_index = 0; variant_index < cap_desc.variantCount; ++variant_index) {
                 const detail::VpVariantDesc& variant = cap_desc.pVariants[variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -1226,13 +1373,15 @@ VPAPI_ATTR VkResult vpGetProfileVideoProfileDesc(
         const detail::VpProfileDesc* profile_desc = detail::vpGetProfileDesc(gathered_profiles[profile_index].profileName);
         if (profile_desc == nullptr) return VK_ERROR_UNKNOWN;
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*profile_desc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t capability_index = 0; capability_index < profile_desc->requiredCapabilityCount; ++capability_index) {
             const detail::VpCapabilitiesDesc& cap_desc = profile_desc->pRequiredCapabilities[capability_index];
 
             for (uint32_t variant_index = 0; variant_index < cap_desc.variantCount; ++variant_index) {
                 const detail::VpVariantDesc& variant = cap_desc.pVariants[variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -1254,6 +1403,140 @@ VPAPI_ATTR VkResult vpGetProfileVideoProfileDesc(
 '''
 
 PUBLIC_IMPL_BODY = '''
+struct VpPhysicalDeviceSnapshot_T {
+    VpFunctions_T*                      pFunctions = nullptr;
+    VpPhysicalDeviceSnapshot            pNextSnapshot = nullptr;
+    VkPhysicalDevice                    physicalDevice = VK_NULL_HANDLE;
+
+    // Never modified once captured, Invalidate() replaces the whole block so that the running queries keep reading theirs
+    struct Capabilities {
+        uint32_t                            apiVersion = 0;
+        uint32_t                            queueFamilyCount = 0;
+        std::vector<VkExtensionProperties>  deviceExtensions;
+    };
+
+    std::mutex                          mutex;
+    std::shared_ptr<const Capabilities> pCapabilities;
+
+    detail::VpStructureStore            features;
+    detail::VpStructureStore            properties;
+    detail::VpStructureStore            formats;
+    detail::VpStructureStore            queueFamilies;
+
+    // Query the device extensions, the API version and the queue family count, the structures are captured by the support queries
+    VkResult Capture(const VpFunctions_T& vp, std::shared_ptr<const Capabilities>* pCaptured) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->pCapabilities != nullptr) {
+            *pCaptured = this->pCapabilities;
+            return VK_SUCCESS;
+        }
+
+        std::shared_ptr<Capabilities> capabilities = std::make_shared<Capabilities>();
+
+        uint32_t extension_count = 0;
+        VkResult result = vp.EnumerateDeviceExtensionProperties(this->physicalDevice, nullptr, &extension_count, nullptr);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+        capabilities->deviceExtensions.resize(extension_count);
+        result = vp.EnumerateDeviceExtensionProperties(this->physicalDevice, nullptr, &extension_count, capabilities->deviceExtensions.data());
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+        capabilities->deviceExtensions.resize(extension_count);
+
+        VkPhysicalDeviceProperties2KHR properties2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR };
+        vp.GetPhysicalDeviceProperties2(this->physicalDevice, &properties2);
+        capabilities->apiVersion = properties2.properties.apiVersion;
+
+        vp.GetPhysicalDeviceQueueFamilyProperties2(this->physicalDevice, &capabilities->queueFamilyCount, nullptr);
+
+        this->pCapabilities = capabilities;
+        *pCaptured = this->pCapabilities;
+        return VK_SUCCESS;
+    }
+
+    void Invalidate() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pCapabilities.reset();
+        this->features.Clear();
+        this->properties.Clear();
+        this->formats.Clear();
+        this->queueFamilies.Clear();
+    }
+};
+
+VPAPI_ATTR VkResult vpCreatePhysicalDeviceSnapshot(
+#ifdef VP_USE_OBJECT
+    VpFunctions                                 functions,
+#endif//VP_USE_OBJECT
+    VkPhysicalDevice                            physicalDevice,
+    VpPhysicalDeviceSnapshot*                   pSnapshot) {
+#ifdef VP_USE_OBJECT
+    VpFunctions_T& vp = functions == nullptr ? VpFunctions_T::Get() : *functions;
+#else
+    VpFunctions_T& vp = VpFunctions_T::Get();
+#endif//VP_USE_OBJECT
+
+    VkResult result_validate = vp.validate(true);
+    if (result_validate != VK_SUCCESS) {
+        return result_validate;
+    }
+
+    // A physical device has at most one snapshot per functions object
+    for (VpPhysicalDeviceSnapshot snapshot = vp.pSnapshots; snapshot != nullptr; snapshot = snapshot->pNextSnapshot) {
+        if (snapshot->physicalDevice == physicalDevice) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+    }
+
+    VpPhysicalDeviceSnapshot snapshot = new (std::nothrow) VpPhysicalDeviceSnapshot_T();
+    if (snapshot == nullptr) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    snapshot->pFunctions = &vp;
+    snapshot->physicalDevice = physicalDevice;
+
+    VkResult result = snapshot->Capture(vp);
+    if (result != VK_SUCCESS) {
+        delete snapshot;
+        return result;
+    }
+
+    snapshot->pNextSnapshot = vp.pSnapshots;
+    vp.pSnapshots = snapshot;
+
+    *pSnapshot = snapshot;
+    return VK_SUCCESS;
+}
+
+VPAPI_ATTR void vpInvalidatePhysicalDeviceSnapshot(
+    VpPhysicalDeviceSnapshot                    snapshot) {
+    if (snapshot != nullptr) {
+        snapshot->Invalidate();
+    }
+}
+
+VPAPI_ATTR void vpDestroyPhysicalDeviceSnapshot(
+    VpPhysicalDeviceSnapshot                    snapshot) {
+    if (snapshot == nullptr) {
+        return;
+    }
+
+    // The functions object is already destroyed when pFunctions is null
+    if (snapshot->pFunctions != nullptr) {
+        VpPhysicalDeviceSnapshot* pLink = &snapshot->pFunctions->pSnapshots;
+        while (*pLink != nullptr && *pLink != snapshot) {
+            pLink = &(*pLink)->pNextSnapshot;
+        }
+        if (*pLink == snapshot) {
+            *pLink = snapshot->pNextSnapshot;
+        }
+    }
+
+    delete snapshot;
+}
+
 #ifdef VP_USE_OBJECT
 
 VPAPI_ATTR VkResult vpCreateFunctions(
@@ -1296,7 +1579,12 @@ VPAPI_ATTR void vpDestroyFunctions(
     VpFunctions                                 functions,
     const VkAllocationCallbacks*                pAllocator) {
     (void)pAllocator;
-    
+
+    // Snapshots may outlive the functions object, they are detached from it
+    for (VpPhysicalDeviceSnapshot snapshot = functions->pSnapshots; snapshot != nullptr; snapshot = snapshot->pNextSnapshot) {
+        snapshot->pFunctions = nullptr;
+    }
+
     delete functions;
 }
 
@@ -1748,6 +2036,8 @@ VPAPI_ATTR VkResult vpCreateInstance(
             return VK_ERROR_UNKNOWN;
         }
 
+        const detail::VpBlockVariants block_variants = detail::vpGetBlockVariants(*profile_desc, blocks[block_index].blockName);
+
         for (std::size_t caps_index = 0, caps_count = profile_desc->requiredCapabilityCount; caps_index < caps_count; ++caps_index) {
             const detail::VpCapabilitiesDesc* caps_desc = &profile_desc->pRequiredCapabilities[caps_index];
 
@@ -1755,7 +2045,7 @@ VPAPI_ATTR VkResult vpCreateInstance(
                 const detail::VpVariantDesc* variant = &caps_desc->pVariants[variant_index];
 
                 if (strcmp(blocks[block_index].blockName, "") != 0) {
-                    if (strcmp(variant->blockName, blocks[block_index].blockName) != 0) {
+                    if (!block_variants.Contains(variant)) {
                         continue;
                     }
                 }
@@ -1835,47 +2125,56 @@ VPAPI_ATTR VkResult vpCreateInstance(
     return result;
 }
 
-VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
-#ifdef VP_USE_OBJECT
-    VpFunctions                                 functions,
-#endif//VP_USE_OBJECT
+namespace detail {
+
+VPAPI_ATTR VpPhysicalDeviceSnapshot vpFindPhysicalDeviceSnapshot(const VpFunctions_T& vp, VkPhysicalDevice physicalDevice) {
+    for (VpPhysicalDeviceSnapshot snapshot = vp.pSnapshots; snapshot != nullptr; snapshot = snapshot->pNextSnapshot) {
+        if (snapshot->physicalDevice == physicalDevice) {
+            return snapshot;
+        }
+    }
+    return nullptr;
+}
+
+// Check a profile and the profiles it requires, the blocks are the supported blocks when the profile is supported
+// and the unsupported blocks otherwise. The functions must be validated by the caller.
+VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileBlocksSupport(
+    const VpFunctions_T&                        vp,
     VkInstance                                  instance,
     VkPhysicalDevice                            physicalDevice,
+    VpPhysicalDeviceSnapshot                    snapshot,
     const VpProfileProperties*                  pProfile,
     VkBool32*                                   pSupported,
-    uint32_t*                                   pPropertyCount,
-    VpBlockProperties*                          pProperties) {
-#ifdef VP_USE_OBJECT
-    const VpFunctions_T& vp = functions == nullptr ? VpFunctions_T::Get() : *functions;
-#else
-    const VpFunctions_T& vp = VpFunctions_T::Get();
-#endif//VP_USE_OBJECT
-
-    VkResult result_validate = vp.validate(true);
-    if (result_validate != VK_SUCCESS) {
-        return result_validate;
-    }
-
+    std::vector<VpBlockProperties>&             blocks) {
     VkResult result = VK_SUCCESS;
 
-    uint32_t supported_device_extension_count = 0;
-    result = vp.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &supported_device_extension_count, nullptr);
-    if (result != VK_SUCCESS) {
-        return result;
-    }
     std::vector<VkExtensionProperties> supported_device_extensions;
-    if (supported_device_extension_count > 0) {
-        supported_device_extensions.resize(supported_device_extension_count);
-    }
-    result = vp.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &supported_device_extension_count, supported_device_extensions.data());
-    if (result != VK_SUCCESS) {
-        return result;
-    }
+    std::shared_ptr<const VpPhysicalDeviceSnapshot_T::Capabilities> captured;
+    if (snapshot != nullptr) {
+        result = snapshot->Capture(vp, &captured);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+    } else {
+        uint32_t supported_device_extension_count = 0;
+        result = vp.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &supported_device_extension_count, nullptr);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+        if (supported_device_extension_count > 0) {
+            supported_device_extensions.resize(supported_device_extension_count);
+        }
+        result = vp.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &supported_device_extension_count, supported_device_extensions.data());
+        if (result != VK_SUCCESS) {
+            return result;
+        }
 
-    // Workaround old loader bug where count could be smaller on the second call to vkEnumerateDeviceExtensionProperties
-    if (supported_device_extension_count > 0) {
-        supported_device_extensions.resize(supported_device_extension_count);
+        // Workaround old loader bug where count could be smaller on the second call to vkEnumerateDeviceExtensionProperties
+        if (supported_device_extension_count > 0) {
+            supported_device_extensions.resize(supported_device_extension_count);
+        }
     }
+    const std::vector<VkExtensionProperties>& device_extensions = captured != nullptr ? captured->deviceExtensions : supported_device_extensions;
 
     {
         const detail::VpProfileDesc* pProfileDesc = detail::vpGetProfileDesc(pProfile->profileName);
@@ -1910,6 +2209,7 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
         VkPhysicalDevice physicalDevice;
         std::vector<VpBlockProperties>& supported_blocks;
         std::vector<VpBlockProperties>& unsupported_blocks;
+        VpPhysicalDeviceSnapshot snapshot;
         const detail::VpVariantDesc* variant;
         GPDP2EntryPoints gpdp2;
 #ifdef VK_KHR_video_queue
@@ -1918,7 +2218,7 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
         uint32_t index;
         detail::PFN_vpStructChainerCb pfnCb;
         bool supported;
-    } userData{physicalDevice, supported_blocks, unsupported_blocks};
+    } userData{physicalDevice, supported_blocks, unsupported_blocks, snapshot};
 
     userData.gpdp2.pfnGetPhysicalDeviceFeatures2 = vp.GetPhysicalDeviceFeatures2;
     userData.gpdp2.pfnGetPhysicalDeviceProperties2 = vp.GetPhysicalDeviceProperties2;
@@ -1955,16 +2255,22 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
         bool supported_profile = true;
 
         if (profile_desc->props.specVersion < gathered_profiles[profile_index].specVersion) {
-            VP_DEBUG_MSGF("Unsupported requested %s profile version: %u, profile supported at version %u", profile_name, profile_desc->props.specVersion, pProfile->specVersion);
+            VP_DEBUG_MSGF("Unsupported requested %s profile version: %u, profile supported at version %u", profile_name, gathered_profiles[profile_index].specVersion, profile_desc->props.specVersion);
             supported_profile = false;
         }
 
         VpBlockProperties block{gathered_profiles[profile_index], profile_desc->minApiVersion};
 
         {
-            VkPhysicalDeviceProperties2KHR properties2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR };
-            userData.gpdp2.pfnGetPhysicalDeviceProperties2(physicalDevice, &properties2);
-            if (!detail::vpCheckVersion(properties2.properties.apiVersion, profile_desc->minApiVersion)) {
+            uint32_t device_api_version = 0;
+            if (captured != nullptr) {
+                device_api_version = captured->apiVersion;
+            } else {
+                VkPhysicalDeviceProperties2KHR properties2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR };
+                userData.gpdp2.pfnGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+                device_api_version = properties2.properties.apiVersion;
+            }
+            if (!detail::vpCheckVersion(device_api_version, profile_desc->minApiVersion)) {
                 VP_DEBUG_MSGF("Unsupported API version: %u.%u.%u", VK_API_VERSION_MAJOR(profile_desc->minApiVersion), VK_API_VERSION_MINOR(profile_desc->minApiVersion), VK_API_VERSION_PATCH(profile_desc->minApiVersion));
                 supported_profile = false;
             }
@@ -1982,7 +2288,7 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
 
                 for (uint32_t ext_index = 0; ext_index < variant_desc.deviceExtensionCount; ++ext_index) {
                     const char *requested_extension = variant_desc.pDeviceExtensions[ext_index].extensionName;
-                    if (!detail::CheckExtension(supported_device_extensions.data(), supported_device_extensions.size(), requested_extension)) {
+                    if (!detail::CheckExtension(device_extensions.data(), device_extensions.size(), requested_extension)) {
                         supported_variant = false;
                     }
                 }
@@ -1995,9 +2301,14 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
                         static_cast<VkBaseOutStructure*>(static_cast<void*>(&features)), &userData,
                         [](VkBaseOutStructure* p, void* pUser) {
                             UserData* pUserData = static_cast<UserData*>(pUser);
-                            pUserData->gpdp2.pfnGetPhysicalDeviceFeatures2(
-                                pUserData->physicalDevice,
-                                static_cast<VkPhysicalDeviceFeatures2KHR*>(static_cast<void*>(p)));
+                            if (pUserData->snapshot == nullptr || !pUserData->snapshot->features.Load(0, p)) {
+                                pUserData->gpdp2.pfnGetPhysicalDeviceFeatures2(
+                                    pUserData->physicalDevice,
+                                    static_cast<VkPhysicalDeviceFeatures2KHR*>(static_cast<void*>(p)));
+                                if (pUserData->snapshot != nullptr) {
+                                    pUserData->snapshot->features.Store(0, p);
+                                }
+                            }
 
                             pUserData->supported = true;
                             while (p != nullptr) {
@@ -2019,9 +2330,14 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
                         static_cast<VkBaseOutStructure*>(static_cast<void*>(&device_properties2)), &userData,
                         [](VkBaseOutStructure* p, void* pUser) {
                             UserData* pUserData = static_cast<UserData*>(pUser);
-                            pUserData->gpdp2.pfnGetPhysicalDeviceProperties2(
-                                pUserData->physicalDevice,
-                                static_cast<VkPhysicalDeviceProperties2KHR*>(static_cast<void*>(p)));
+                            if (pUserData->snapshot == nullptr || !pUserData->snapshot->properties.Load(0, p)) {
+                                pUserData->gpdp2.pfnGetPhysicalDeviceProperties2(
+                                    pUserData->physicalDevice,
+                                    static_cast<VkPhysicalDeviceProperties2KHR*>(static_cast<void*>(p)));
+                                if (pUserData->snapshot != nullptr) {
+                                    pUserData->snapshot->properties.Store(0, p);
+                                }
+                            }
 
                             pUserData->supported = true;
                             while (p != nullptr) {
@@ -2039,14 +2355,27 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
 
                 if (supported_variant && userData.variant->queueFamilyCount > 0) {
                     uint32_t queue_family_count = 0;
-                    userData.gpdp2.pfnGetPhysicalDeviceQueueFamilyProperties2(physicalDevice, &queue_family_count, nullptr);
+                    if (captured != nullptr) {
+                        queue_family_count = captured->queueFamilyCount;
+                    } else {
+                        userData.gpdp2.pfnGetPhysicalDeviceQueueFamilyProperties2(physicalDevice, &queue_family_count, nullptr);
+                    }
                     std::vector<VkQueueFamilyProperties2KHR> queueFamilyProps(queue_family_count, { VK_STRUCTURE_TYPE_QUEUE_FAMILY_PROPERTIES_2_KHR });
                     userData.variant->chainers.pfnQueueFamily(
                         queue_family_count, static_cast<VkBaseOutStructure*>(static_cast<void*>(queueFamilyProps.data())), &userData,
                         [](uint32_t queue_family_count, VkBaseOutStructure* pBaseArray, void* pUser) {
                             UserData* pUserData = static_cast<UserData*>(pUser);
                             VkQueueFamilyProperties2KHR* pArray = static_cast<VkQueueFamilyProperties2KHR*>(static_cast<void*>(pBaseArray));
-                            pUserData->gpdp2.pfnGetPhysicalDeviceQueueFamilyProperties2(pUserData->physicalDevice, &queue_family_count, pArray);
+                            bool loaded = pUserData->snapshot != nullptr;
+                            for (uint32_t i = 0; loaded && i < queue_family_count; ++i) {
+                                loaded = pUserData->snapshot->queueFamilies.Load(i, static_cast<VkBaseOutStructure*>(static_cast<void*>(&pArray[i])));
+                            }
+                            if (!loaded) {
+                                pUserData->gpdp2.pfnGetPhysicalDeviceQueueFamilyProperties2(pUserData->physicalDevice, &queue_family_count, pArray);
+                                for (uint32_t i = 0; pUserData->snapshot != nullptr && i < queue_family_count; ++i) {
+                                    pUserData->snapshot->queueFamilies.Store(i, static_cast<VkBaseOutStructure*>(static_cast<void*>(&pArray[i])));
+                                }
+                            }
                             pUserData->supported = true;
                             for (uint32_t profile_qf_idx = 0; profile_qf_idx < pUserData->variant->queueFamilyCount; ++profile_qf_idx) {
                                 bool found_matching = false;
@@ -2083,10 +2412,15 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
                         static_cast<VkBaseOutStructure*>(static_cast<void*>(&format_properties2)), &userData,
                         [](VkBaseOutStructure* p, void* pUser) {
                             UserData* pUserData = static_cast<UserData*>(pUser);
-                            pUserData->gpdp2.pfnGetPhysicalDeviceFormatProperties2(
-                                pUserData->physicalDevice,
-                                pUserData->variant->pFormats[pUserData->index].format,
-                                static_cast<VkFormatProperties2KHR*>(static_cast<void*>(p)));
+                            const VkFormat format = pUserData->variant->pFormats[pUserData->index].format;
+                            if (pUserData->snapshot == nullptr || !pUserData->snapshot->formats.Load(format, p)) {
+                                pUserData->gpdp2.pfnGetPhysicalDeviceFormatProperties2(
+                                    pUserData->physicalDevice, format,
+                                    static_cast<VkFormatProperties2KHR*>(static_cast<void*>(p)));
+                                if (pUserData->snapshot != nullptr) {
+                                    pUserData->snapshot->formats.Store(format, p);
+                                }
+                            }
                             pUserData->supported = true;
                             while (p != nullptr) {
                                 if (!pUserData->variant->pFormats[pUserData->index].pfnComparator(p)) {
@@ -2228,7 +2562,75 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
         }
     }
 
-    const std::vector<VpBlockProperties>& blocks = supported ? supported_blocks : unsupported_blocks;
+    blocks.swap(supported ? supported_blocks : unsupported_blocks);
+
+    *pSupported = supported ? VK_TRUE : VK_FALSE;
+    return VK_SUCCESS;
+}
+
+// Check a list of profiles, the unsupported blocks of the unsupported profiles are appended to unsupported_blocks
+VPAPI_ATTR VkResult vpGetPhysicalDeviceProfilesSupport(
+    const VpFunctions_T&                        vp,
+    VkInstance                                  instance,
+    VkPhysicalDevice                            physicalDevice,
+    uint32_t                                    profileCount,
+    const VpProfileProperties*                  pProfiles,
+    VkBool32*                                   pSupported,
+    std::vector<VpBlockProperties>&             unsupported_blocks) {
+    // Without a snapshot of the physical device, a snapshot local to this call shares the driver queries between the profiles
+    VpPhysicalDeviceSnapshot snapshot = detail::vpFindPhysicalDeviceSnapshot(vp, physicalDevice);
+    VpPhysicalDeviceSnapshot_T local_snapshot;
+    if (snapshot == nullptr) {
+        local_snapshot.physicalDevice = physicalDevice;
+        snapshot = &local_snapshot;
+    }
+
+    std::vector<VpBlockProperties> blocks;
+    for (uint32_t profile_index = 0; profile_index < profileCount; ++profile_index) {
+        VkResult result = detail::vpGetPhysicalDeviceProfileBlocksSupport(
+            vp, instance, physicalDevice, snapshot, &pProfiles[profile_index], &pSupported[profile_index], blocks);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        if (pSupported[profile_index] == VK_FALSE) {
+            unsupported_blocks.insert(unsupported_blocks.end(), blocks.begin(), blocks.end());
+        }
+        blocks.clear();
+    }
+
+    return VK_SUCCESS;
+}
+
+} // namespace detail
+
+VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
+#ifdef VP_USE_OBJECT
+    VpFunctions                                 functions,
+#endif//VP_USE_OBJECT
+    VkInstance                                  instance,
+    VkPhysicalDevice                            physicalDevice,
+    const VpProfileProperties*                  pProfile,
+    VkBool32*                                   pSupported,
+    uint32_t*                                   pPropertyCount,
+    VpBlockProperties*                          pProperties) {
+#ifdef VP_USE_OBJECT
+    const VpFunctions_T& vp = functions == nullptr ? VpFunctions_T::Get() : *functions;
+#else
+    const VpFunctions_T& vp = VpFunctions_T::Get();
+#endif//VP_USE_OBJECT
+
+    VkResult result_validate = vp.validate(true);
+    if (result_validate != VK_SUCCESS) {
+        return result_validate;
+    }
+
+    std::vector<VpBlockProperties> blocks;
+    VkResult result = detail::vpGetPhysicalDeviceProfileBlocksSupport(
+        vp, instance, physicalDevice, detail::vpFindPhysicalDeviceSnapshot(vp, physicalDevice), pProfile, pSupported, blocks);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
 
     if (pProperties == nullptr) {
         *pPropertyCount = static_cast<uint32_t>(blocks.size());
@@ -2243,10 +2645,179 @@ VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileVariantsSupport(
         }
     }
 
-    *pSupported = supported ? VK_TRUE : VK_FALSE;
     return VK_SUCCESS;
 }
 
+VPAPI_ATTR VkResult vpGetPhysicalDeviceProfilesSupport(
+#ifdef VP_USE_OBJECT
+    VpFunctions                                 functions,
+#endif//VP_USE_OBJECT
+    VkInstance                                  instance,
+    VkPhysicalDevice                            physicalDevice,
+    uint32_t                                    profileCount,
+    const VpProfileProperties*                  pProfiles,
+    VkBool32*                                   pSupported,
+    uint32_t*                                   pPropertyCount,
+    VpBlockProperties*                          pProperties) {
+#ifdef VP_USE_OBJECT
+    const VpFunctions_T& vp = functions == nullptr ? VpFunctions_T::Get() : *functions;
+#else
+    const VpFunctions_T& vp = VpFunctions_T::Get();
+#endif//VP_USE_OBJECT
+
+    VkResult result_validate = vp.validate(true);
+    if (result_validate != VK_SUCCESS) {
+        return result_validate;
+    }
+
+    std::vector<VpBlockProperties> unsupported_blocks;
+    VkResult result = detail::vpGetPhysicalDeviceProfilesSupport(
+        vp, instance, physicalDevice, profileCount, pProfiles, pSupported, unsupported_blocks);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    if (pPropertyCount == nullptr) {
+        return VK_SUCCESS;
+    }
+
+    if (pProperties == nullptr) {
+        *pPropertyCount = static_cast<uint32_t>(unsupported_blocks.size());
+        return VK_SUCCESS;
+    }
+
+    const uint32_t count = std::min(*pPropertyCount, static_cast<uint32_t>(unsupported_blocks.size()));
+    for (uint32_t i = 0; i < count; ++i) {
+        pProperties[i] = unsupported_blocks[i];
+    }
+    *pPropertyCount = count;
+    return count < static_cast<uint32_t>(unsupported_blocks.size()) ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
+VPAPI_ATTR VkResult vpGetPhysicalDeviceRankings(
+#ifdef VP_USE_OBJECT
+    VpFunctions                                 functions,
+#endif//VP_USE_OBJECT
+    VkInstance                                  instance,
+    uint32_t                                    profileCount,
+    const VpProfileProperties*                  pProfiles,
+    VpPhysicalDeviceRankingFlags                flags,
+    uint32_t*                                   pRankingCount,
+    VpPhysicalDeviceRanking*                    pRankings) {
+#ifdef VP_USE_OBJECT
+    const VpFunctions_T& vp = functions == nullptr ? VpFunctions_T::Get() : *functions;
+#else
+    const VpFunctions_T& vp = VpFunctions_T::Get();
+#endif//VP_USE_OBJECT
+
+    VkResult result_validate = vp.validate(true);
+    if (result_validate != VK_SUCCESS) {
+        return result_validate;
+    }
+
+    PFN_vkEnumeratePhysicalDevices pfnEnumeratePhysicalDevices =
+        (PFN_vkEnumeratePhysicalDevices)vp.GetInstanceProcAddr(instance, "vkEnumeratePhysicalDevices");
+    if (pfnEnumeratePhysicalDevices == nullptr) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    uint32_t device_count = 0;
+    VkResult result = pfnEnumeratePhysicalDevices(instance, &device_count, nullptr);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    if (pRankings == nullptr) {
+        *pRankingCount = device_count;
+        return VK_SUCCESS;
+    }
+
+    std::vector<VkPhysicalDevice> devices(device_count);
+    result = pfnEnumeratePhysicalDevices(instance, &device_count, devices.data());
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+    devices.resize(device_count);
+
+    std::vector<VpPhysicalDeviceRanking> rankings(device_count);
+    std::vector<VkResult> results(device_count, VK_SUCCESS);
+
+    const auto rank = [&](uint32_t device_index) {
+        std::vector<VkBool32> supported(profileCount, VK_FALSE);
+        std::vector<VpBlockProperties> unsupported_blocks;
+        results[device_index] = detail::vpGetPhysicalDeviceProfilesSupport(
+            vp, instance, devices[device_index], profileCount, pProfiles, supported.data(), unsupported_blocks);
+
+        VpPhysicalDeviceRanking& ranking = rankings[device_index];
+        ranking.physicalDevice = devices[device_index];
+        ranking.firstSupportedProfileIndex = profileCount;
+        ranking.supportedProfileCount = 0;
+        for (uint32_t profile_index = 0; profile_index < profileCount; ++profile_index) {
+            if (supported[profile_index] == VK_TRUE) {
+                ranking.firstSupportedProfileIndex = std::min(ranking.firstSupportedProfileIndex, profile_index);
+                ++ranking.supportedProfileCount;
+            }
+        }
+    };
+
+    // The physical devices from 1 to thread_count are checked on their own thread, the others on the calling thread
+    uint32_t thread_count = 0;
+#ifdef VP_USE_THREADS
+    std::vector<std::thread> threads;
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+    if ((flags & VP_PHYSICAL_DEVICE_RANKING_PARALLEL_BIT) && device_count > 1) {
+        threads.reserve(device_count - 1);
+        try {
+            for (uint32_t device_index = 1; device_index < device_count; ++device_index) {
+                threads.emplace_back(rank, device_index);
+            }
+        } catch (const std::system_error&) {
+            // The physical devices without a thread are checked serially
+        }
+        thread_count = static_cast<uint32_t>(threads.size());
+    }
+#else
+    // Without exceptions, a failure to create a thread can't be recovered from so the physical devices are checked serially
+    (void)flags;
+#endif
+#else
+    (void)flags;
+#endif//VP_USE_THREADS
+
+    for (uint32_t device_index = 0; device_index < device_count; ++device_index) {
+        if (device_index == 0 || device_index > thread_count) {
+            rank(device_index);
+        }
+    }
+
+#ifdef VP_USE_THREADS
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+#endif//VP_USE_THREADS
+
+    for (uint32_t device_index = 0; device_index < device_count; ++device_index) {
+        if (results[device_index] != VK_SUCCESS) {
+            return results[device_index];
+        }
+    }
+
+    // The profiles are listed by order of preference, ties are broken by the number of supported profiles then by enumeration order
+    std::stable_sort(rankings.begin(), rankings.end(), [](const VpPhysicalDeviceRanking& a, const VpPhysicalDeviceRanking& b) {
+        if (a.firstSupportedProfileIndex != b.firstSupportedProfileIndex) {
+            return a.firstSupportedProfileIndex < b.firstSupportedProfileIndex;
+        }
+        return a.supportedProfileCount > b.supportedProfileCount;
+    });
+
+    const uint32_t count = std::min(*pRankingCount, device_count);
+    for (uint32_t i = 0; i < count; ++i) {
+        pRankings[i] = rankings[i];
+    }
+    *pRankingCount = count;
+    return count < device_count ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
 VPAPI_ATTR VkResult vpGetPhysicalDeviceProfileSupport(
 #ifdef VP_USE_OBJECT
     VpFunctions                                 functions,
@@ -2286,7 +2857,7 @@ VPAPI_ATTR VkResult vpCreateDevice(
         pCreateInfo->enabledFullProfileCount, pCreateInfo->pEnabledFullProfiles,
         pCreateInfo->enabledProfileBlockCount, pCreateInfo->pEnabledProfileBlocks);
 
-    std::unique_ptr<detail::FeaturesChain> chain = std::make_unique<detail::FeaturesChain>();
+    detail::FeaturesChain chain;
     std::vector<VkStructureType> structureTypes;
 
     std::vector<const char*> extensions;
@@ -2300,6 +2871,8 @@ VPAPI_ATTR VkResult vpCreateDevice(
             return VK_ERROR_UNKNOWN;
         }
 
+        const detail::VpBlockVariants block_variants = detail::vpGetBlockVariants(*pProfileDesc, blocks[block_index].blockName);
+
         for (std::size_t caps_index = 0, caps_count = pProfileDesc->requiredCapabilityCount; caps_index < caps_count; ++caps_index) {
             const detail::VpCapabilitiesDesc* pCapsDesc = &pProfileDesc->pRequiredCapabilities[caps_index];
 
@@ -2307,7 +2880,7 @@ VPAPI_ATTR VkResult vpCreateDevice(
                 const detail::VpVariantDesc* variant = &pCapsDesc->pVariants[variant_index];
 
                 if (strcmp(blocks[block_index].blockName, "") != 0) {
-                    if (strcmp(variant->blockName, blocks[block_index].blockName) != 0) {
+                    if (!block_variants.Contains(variant)) {
                         continue;
                     }
                 }
@@ -2327,9 +2900,9 @@ VPAPI_ATTR VkResult vpCreateDevice(
     VkBaseOutStructure* pNext = static_cast<VkBaseOutStructure*>(const_cast<void*>(pCreateInfo->pCreateInfo->pNext));
     detail::GatherStructureTypes(structureTypes, pNext);
 
-    chain->Build(structureTypes);
+    chain.Build(structureTypes);
 
-    VkPhysicalDeviceFeatures2KHR* pFeatures = &chain->requiredFeaturesChain;
+    VkPhysicalDeviceFeatures2KHR* pFeatures = &chain.requiredFeaturesChain;
     if (pCreateInfo->pCreateInfo->pEnabledFeatures) {
         pFeatures->features = *pCreateInfo->pCreateInfo->pEnabledFeatures;
     }
@@ -2361,14 +2934,14 @@ VPAPI_ATTR VkResult vpCreateDevice(
         }
     }
 
-    chain->ApplyFeatures(pCreateInfo);
+    chain.ApplyFeatures(pCreateInfo);
 
     if (pCreateInfo->flags & VP_DEVICE_CREATE_DISABLE_ROBUST_BUFFER_ACCESS_BIT) {
         pFeatures->features.robustBufferAccess = VK_FALSE;
     }
 
     VkDeviceCreateInfo createInfo{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
-    createInfo.pNext = &chain->requiredFeaturesChain;
+    createInfo.pNext = &chain.requiredFeaturesChain;
     createInfo.queueCreateInfoCount = pCreateInfo->pCreateInfo->queueCreateInfoCount;
     createInfo.pQueueCreateInfos = pCreateInfo->pCreateInfo->pQueueCreateInfos;
     createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
@@ -2426,13 +2999,15 @@ VPAPI_ATTR VkResult vpGetProfileFeatures(
         const detail::VpProfileDesc* profile_desc = detail::vpGetProfileDesc(gathered_profiles[profile_index].profileName);
         if (profile_desc == nullptr) return VK_ERROR_UNKNOWN;
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*profile_desc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t capability_index = 0; capability_index < profile_desc->requiredCapabilityCount; ++capability_index) {
             const detail::VpCapabilitiesDesc& cap_desc = profile_desc->pRequiredCapabilities[capability_index];
 
             for (uint32_t variant_index = 0; variant_index < cap_desc.variantCount; ++variant_index) {
                 const detail::VpVariantDesc& variant = cap_desc.pVariants[variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -2480,13 +3055,15 @@ VPAPI_ATTR VkResult vpGetProfileProperties(
         const detail::VpProfileDesc* profile_desc = detail::vpGetProfileDesc(gathered_profiles[profile_index].profileName);
         if (profile_desc == nullptr) return VK_ERROR_UNKNOWN;
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*profile_desc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t capability_index = 0; capability_index < profile_desc->requiredCapabilityCount; ++capability_index) {
             const detail::VpCapabilitiesDesc& cap_desc = profile_desc->pRequiredCapabilities[capability_index];
 
             for (uint32_t variant_index = 0; variant_index < cap_desc.variantCount; ++variant_index) {
                 const detail::VpVariantDesc& variant = cap_desc.pVariants[variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -2530,13 +3107,15 @@ VPAPI_ATTR VkResult vpGetProfileQueueFamilyProperties(
         const detail::VpProfileDesc* profile_desc = detail::vpGetProfileDesc(gathered_profiles[profile_index].profileName);
         if (profile_desc == nullptr) return VK_ERROR_UNKNOWN;
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*profile_desc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t capability_index = 0; capability_index < profile_desc->requiredCapabilityCount; ++capability_index) {
             const detail::VpCapabilitiesDesc& cap_desc = profile_desc->pRequiredCapabilities[capability_index];
 
             for (uint32_t variant_index = 0; variant_index < cap_desc.variantCount; ++variant_index) {
                 const detail::VpVariantDesc& variant = cap_desc.pVariants[variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -2593,13 +3172,15 @@ VPAPI_ATTR VkResult vpGetProfileFormats(
         const detail::VpProfileDesc* profile_desc = detail::vpGetProfileDesc(gathered_profiles[profile_index].profileName);
         if (profile_desc == nullptr) return VK_ERROR_UNKNOWN;
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*profile_desc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t capability_index = 0; capability_index < profile_desc->requiredCapabilityCount; ++capability_index) {
             const detail::VpCapabilitiesDesc& cap_desc = profile_desc->pRequiredCapabilities[capability_index];
 
             for (uint32_t variant_index = 0; variant_index < cap_desc.variantCount; ++variant_index) {
                 const detail::VpVariantDesc& variant = cap_desc.pVariants[variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -2654,6 +3235,8 @@ VPAPI_ATTR VkResult vpGetProfileFormatProperties(
         const detail::VpProfileDesc* pProfileDesc = detail::vpGetProfileDesc(profile_name);
         if (pProfileDesc == nullptr) return VK_ERROR_UNKNOWN;
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*pProfileDesc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t required_capability_index = 0; required_capability_index < pProfileDesc->requiredCapabilityCount;
                 ++required_capability_index) {
             const detail::VpCapabilitiesDesc& required_capabilities = pProfileDesc->pRequiredCapabilities[required_capability_index];
@@ -2661,7 +3244,7 @@ VPAPI_ATTR VkResult vpGetProfileFormatProperties(
             for (uint32_t required_variant_index = 0; required_variant_index < required_capabilities.variantCount; ++required_variant_index) {
                 const detail::VpVariantDesc& variant = required_capabilities.pVariants[required_variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -2790,13 +3373,15 @@ VPAPI_ATTR VkResult vpGetProfileVideoProfiles(
         const detail::VpProfileDesc* profile_desc = detail::vpGetProfileDesc(gathered_profiles[profile_index].profileName);
         if (profile_desc == nullptr) return VK_ERROR_UNKNOWN;
 
+        const detail::VpBlockVariants block_variants = pBlockName != nullptr ? detail::vpGetBlockVariants(*profile_desc, pBlockName) : detail::VpBlockVariants{};
+
         for (uint32_t capability_index = 0; capability_index < profile_desc->requiredCapabilityCount; ++capability_index) {
             const detail::VpCapabilitiesDesc& cap_desc = profile_desc->pRequiredCapabilities[capability_index];
 
             for (uint32_t variant_index = 0; variant_index < cap_desc.variantCount; ++variant_index) {
                 const detail::VpVariantDesc& variant = cap_desc.pVariants[variant_index];
                 if (pBlockName != nullptr) {
-                    if (strcmp(variant.blockName, pBlockName) != 0) {
+                    if (!block_variants.Contains(&variant)) {
                         continue;
                     }
                     result = VK_SUCCESS;
@@ -3022,7 +3607,19 @@ VPAPI_ATTR VkResult vpGetProfileVideoFormatStructureTypes(
 
 PRIVATE_IMPL_FEATURES_CHAIN_IMPL = '''
     VkPhysicalDeviceFeatures2KHR requiredFeaturesChain{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR, nullptr};
-    VkBaseOutStructure* current = nullptr;
+
+    // Zero initialized storage of the feature structures chained to requiredFeaturesChain, only the required structures are allocated
+    std::vector<std::uint64_t> storage;
+
+    // Number of features (VkBool32) of a feature structure
+    static std::size_t GetFeatureCount(VkStructureType type) {
+        const std::size_t size = vpGetStructureSize(type);
+        return size == 0 ? 0 : (size - sizeof(VkBaseOutStructure)) / sizeof(VkBool32);
+    }
+
+    static std::size_t GetStorageCount(VkStructureType type) {
+        return (vpGetStructureSize(type) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    }
 
     void ApplyRobustness(const VpDeviceCreateInfo* pCreateInfo) {
 #ifdef VK_VERSION_1_1
@@ -3066,10 +3663,10 @@ PRIVATE_IMPL_FEATURES_CHAIN_IMPL = '''
         const std::size_t offset = sizeof(VkBaseOutStructure);
         const VkBaseOutStructure* q = reinterpret_cast<const VkBaseOutStructure*>(pCreateInfo->pCreateInfo->pNext);
         while (q) {
-            const std::size_t count = this->structureSize[q->sType];
-            for (std::size_t index = 0; index < count; ++index) {
+            const std::size_t count = GetFeatureCount(q->sType);
+            VkBaseOutStructure* pOutputStruct = reinterpret_cast<VkBaseOutStructure*>(detail::vpGetStructure(&this->requiredFeaturesChain, q->sType));
+            for (std::size_t index = 0; pOutputStruct != nullptr && index < count; ++index) {
                 const VkBaseOutStructure* pInputStruct = reinterpret_cast<const VkBaseOutStructure*>(q);
-                VkBaseOutStructure* pOutputStruct = reinterpret_cast<VkBaseOutStructure*>(detail::vpGetStructure(&this->requiredFeaturesChain, q->sType));
                 const uint8_t* pInputData = reinterpret_cast<const uint8_t*>(pInputStruct) + offset;
                 uint8_t* pOutputData = reinterpret_cast<uint8_t*>(pOutputStruct) + offset;
                 const VkBool32* input = reinterpret_cast<const VkBool32*>(pInputData);
@@ -3091,18 +3688,28 @@ PRIVATE_IMPL_FEATURES_CHAIN_IMPL = '''
         last->pNext = found;
     }
 
+    // Build must be called once, the structures are not moved when they are chained
     void Build(const std::vector<VkStructureType>& requiredList) {
+        std::size_t storage_count = 0;
+        for (std::size_t i = 0, n = requiredList.size(); i < n; ++i) {
+            storage_count += GetStorageCount(requiredList[i]);
+        }
+        this->storage.resize(storage_count);
+
+        std::size_t storage_offset = 0;
         for (std::size_t i = 0, n = requiredList.size(); i < n; ++i) {
             const VkStructureType sType = requiredList[i];
-            if (sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR) {
+            if (sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR || GetFeatureCount(sType) == 0) {
                 continue;
             }
-
-            VkBaseOutStructure* found = vpExtractStructure(&physicalDeviceFeatures2KHR, sType);
-            if (found == nullptr) {
+            if (vpGetStructure(&this->requiredFeaturesChain, sType) != nullptr) {
                 continue;
             }
 
+            VkBaseOutStructure* found = reinterpret_cast<VkBaseOutStructure*>(&this->storage[storage_offset]);
+            storage_offset += GetStorageCount(sType);
+            found->sType = sType;
+
             PushBack(found);
         }
     }
@@ -5819,6 +6426,7 @@ class VulkanProfilesLibraryGenerator():
         gen += self.gen_profilePrivateImpl()
         gen += self.gen_profileDescTable()
         gen += self.gen_profileFeatureChain()
+        gen += self.gen_structureSizeTable()
         gen += PRIVATE_IMPL_BODY
         gen += '\n} // namespace detail\n'
         return self.patch_code(gen)
@@ -5916,6 +6524,17 @@ class VulkanProfilesLibraryGenerator():
             gen += '    };\n'
             gen += '    static const uint32_t capabilityCount = static_cast<uint32_t>(std::size(capabilities));\n'
 
+            block_index = []
+            for capability_keys in profile_value.referencedCapabilities:
+                variant_keys = capability_keys if type(capability_keys).__name__ == 'list' else [ capability_keys ]
+                for variant_index, capability_key in enumerate(variant_keys):
+                    block_index.append((profile_value.split_capabilities[capability_key].blockName, self.get_blockName(capability_keys), variant_index))
+            gen += '\n    static const VpVariantDesc* const sortedBlocks[] = {\n'
+            for block_name, capability_name, variant_index in sorted(block_index):
+                gen += ('        &blocks::{0}::variants[{1}],\n').format(capability_name, variant_index)
+            gen += '    };\n'
+            gen += '    static const uint32_t sortedBlockCount = static_cast<uint32_t>(std::size(sortedBlocks));\n'
+
             if profile_value.fallbacks:
                 gen += ('\n'
                     '    static const VpProfileProperties fallbacks[] = {\n')
@@ -5935,6 +6554,7 @@ class VulkanProfilesLibraryGenerator():
             gen += ('}} // namespace {0}\n').format(profile_ukey)
             gen += ('#endif //{0}\n\n').format(profile_key)
 
+        # Sorted by profile name for the binary search of vpGetProfileDesc
         gen += 'static const VpProfileDesc profiles[] = {\n'
         for profile_key, profile_value in sorted(self.profiles_files.profiles.items()):
             profile_ukey = profile_key.upper()
@@ -5955,6 +6575,7 @@ class VulkanProfilesLibraryGenerator():
                 gen += ('        {1}::fallbackCount, {1}::fallbacks,\n').format(profile_key, profile_ukey)
             else:
                 gen += ('        0, nullptr,\n')
+            gen += ('        {0}::sortedBlockCount, {0}::sortedBlocks,\n').format(profile_ukey)
             gen += ('    }},\n'
                     '#endif // {0}\n').format(profile_ukey)
 
@@ -5962,118 +6583,47 @@ class VulkanProfilesLibraryGenerator():
                 'static const uint32_t profileCount = static_cast<uint32_t>(std::size(profiles));\n')
         return gen
 
-    def gen_StructureSizeImpl(self):
+    def gen_profileFeatureChain(self):
         gen = '\n'
-        for struct_key, struct_data in self.registry.structs.items():
-            if 'VkPhysicalDeviceFeatures2' not in struct_data.extends or 'VkDeviceCreateInfo' not in struct_data.extends:
-                continue
-
-            struct_non_alias = self.registry.getNonAliasTypeName(struct_key, self.registry.structs)
-            if struct_non_alias != struct_key:
-                continue
-
-            platform_protection = False
-            for extension in struct_data.definedByExtensions:
-                platform = self.registry.extensions[extension].platform
-                if platform:
-                    gen += '#ifdef {0}\n'.format(self.registry.platforms[platform].protect)
-                    platform_protection = True
-
-            gen += '        this->structureSize.insert({{ {0}, size<{1}>() }});\n'.format(struct_data.sType, struct_key)
-
-            if platform_protection:
-                gen += '#endif\n'
-
-        gen += '        this->structureSize.insert({ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR, size<VkPhysicalDeviceFeatures2KHR>() });'
+        gen += 'struct FeaturesChain {\n'
+        gen += PRIVATE_IMPL_FEATURES_CHAIN_IMPL
+        gen += '}; // struct FeaturesChain\n'
         return gen
 
-    def gen_StructureFeatureChain(self):
-        gen = '\n        //Initializing the full list of available structure features\n'
-        gen += '        void* pNext = nullptr;\n'
+    def gen_structureSizeTable(self):
+        # Size of the structures returned by the physical device queries, used by the snapshots to copy them and
+        # by FeaturesChain to allocate the feature structures of the device creation
+        # Structures with pointer members have no size so that pointers to application memory are never stored
+        base_structs = [ 'VkPhysicalDeviceFeatures2', 'VkPhysicalDeviceProperties2', 'VkFormatProperties2', 'VkQueueFamilyProperties2' ]
 
+        gen = '\nVPAPI_ATTR std::size_t vpGetStructureSize(VkStructureType type) {\n'
+        gen += '    switch (type) {\n'
         for struct_key, struct_data in self.registry.structs.items():
-            if 'VkPhysicalDeviceFeatures2' not in struct_data.extends or 'VkDeviceCreateInfo' not in struct_data.extends:
+            if struct_key not in base_structs and not any(base in struct_data.extends for base in base_structs):
                 continue
 
             struct_non_alias = self.registry.getNonAliasTypeName(struct_key, self.registry.structs)
-            if struct_non_alias != struct_key:
-                continue
-
-            currentVarName = struct_key[2].lower() + struct_key[3:]
-
-            platform_protection = False
-            for extension in struct_data.definedByExtensions:
-                platform = self.registry.extensions[extension].platform
-                if platform:
-                    gen += '#ifdef {0}\n'.format(self.registry.platforms[platform].protect)
-                    platform_protection = True
-
-            gen += '        {0}.pNext = pNext;\n'.format(currentVarName)
-            gen += '        pNext = &{0};\n'.format(currentVarName)
- 
-            if platform_protection:
-                gen += '#endif\n'
-
-        gen += "        physicalDeviceFeatures2KHR.pNext = pNext;\n"
-
-        return gen
-
-    def gen_StructureFeatureImpl(self):
-        gen = '\n'
-
-        for struct_key, struct_data in self.registry.structs.items():
-            if 'VkPhysicalDeviceFeatures2' not in struct_data.extends or 'VkDeviceCreateInfo' not in struct_data.extends:
+            if struct_non_alias != struct_key or struct_data.sType is None:
                 continue
 
-            struct_non_alias = self.registry.getNonAliasTypeName(struct_key, self.registry.structs)
-            if struct_non_alias != struct_key:
+            if any(member.arraySizeMember is not None or member.nullTerminated for member in struct_data.members.values()):
                 continue
 
-            currentVarName = struct_key[2].lower() + struct_key[3:]
-
-            platform_protection = False
+            protects = []
             for extension in struct_data.definedByExtensions:
                 platform = self.registry.extensions[extension].platform
-                if platform:
-                    gen += '#ifdef {0}\n'.format(self.registry.platforms[platform].protect)
-                    platform_protection = True
+                if platform and self.registry.platforms[platform].protect not in protects:
+                    protects.append(self.registry.platforms[platform].protect)
 
-            gen += '    {0} {1}{{ {2}, nullptr }};\n'.format(struct_key, currentVarName, struct_data.sType)
- 
-            if platform_protection:
+            if protects:
+                gen += '#if {0}\n'.format(' || '.join('defined({0})'.format(protect) for protect in protects))
+            gen += '        case {0}: return sizeof({1});\n'.format(struct_data.sType, struct_key)
+            if protects:
                 gen += '#endif\n'
 
-        gen += "    VkPhysicalDeviceFeatures2KHR physicalDeviceFeatures2KHR{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR, nullptr };\n"
-
-        return gen
-
-    def gen_profileFeatureChain(self):
-        genStructureSize = self.gen_StructureSizeImpl()
-        genStructureFeatures = self.gen_StructureFeatureImpl()
-        gen_StructureFeatureChain = self.gen_StructureFeatureChain()
-
-        gen = '\n'
-        gen += '''
-struct FeaturesChain {
-    std::map<VkStructureType, std::size_t> structureSize;
-
-    template<typename T>
-    constexpr std::size_t size() const {
-        return (sizeof(T) - sizeof(VkBaseOutStructure)) / sizeof(VkBool32);
-    }\n'''
-
-        gen += '''\n\t// Chain with all Vulkan Features structures{0}'''.format(genStructureFeatures)
-
-        gen += '''
-    FeaturesChain() {{
-        // Initializing all feature structures, number of Features (VkBool32) per structure.{0}\n{1}
-    }}\n\n'''.format(genStructureSize, gen_StructureFeatureChain)
-
-        gen += PRIVATE_IMPL_FEATURES_CHAIN_IMPL
-
-        gen += '}; // struct FeaturesChain\n'
-
-        Template(gen).substitute(genStructureSize=genStructureSize, genStructureFeatures=genStructureFeatures)
+        gen += '        default: return 0;\n'
+        gen += '    }\n'
+        gen += '}\n'
         return gen
 
     def gen_videoProfileEnumerator(self):
@@ -31,6 +31,7 @@ from source.main_tests import main_tests
 from source.main_merge import main_merge
 from source.main_library import main_library
 from source.main_doc import main_doc
+from source.main_log import main_log
 
 
 class ValidateAction(argparse.Action):
@@ -131,6 +132,10 @@ def main(argv):
     tests_parser.add_argument('--output-profile', action='store', required=True, help='Output profile test file.')
     tests_parser.add_argument('--output-cpp', action='store', help='Output C++ tests file.')
 
+    log_parser = subparsers.add_parser('log', help='Decode a binary log file of the Vulkan profiles layer into text.')
+    log_parser.add_argument('--input', '-i', action='store', required=True, help='Path to the binary log file.')
+    log_parser.add_argument('--output', '-o', action='store', help='Output text file. By default, the messages are written to stdout.')
+
     args = parser.parse_args(argv)
 
     if args.command == 'convert':
@@ -149,6 +154,8 @@ def main(argv):
         main_layer(args)
     elif args.command == 'tests':
         main_tests(args)
+    elif args.command == 'log':
+        main_log(args)
     else:
         parser.print_help()
 
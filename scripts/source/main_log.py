@@ -0,0 +1,169 @@
+#!/usr/bin/python3
+#
+# Copyright (c) 2026-2026 Google, Inc.
+# Copyright (C) 2026-2026 Valve Corporation
+# Copyright (c) 2026-2026 LunarG, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License")
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Authors: 
+# - Christophe Riccio <christophe@lunarg.com>
+
+import datetime
+import re
+import struct
+import sys
+
+from source.log import Log
+
+# Decoder of the binary log file written by the profiles layer with DEBUG_ACTION_BINARY_FILE_BIT, see BinaryLogWriter in
+# layer/profiles_settings.cpp for the file layout
+
+BINARY_LOG_MAGIC = b'VPLB'
+BINARY_LOG_VERSION = 1
+
+RECORD_FORMAT = 0
+RECORD_MESSAGE = 1
+
+ARGUMENT_INT = 0
+ARGUMENT_UINT = 1
+ARGUMENT_DOUBLE = 2
+ARGUMENT_STRING = 3
+ARGUMENT_POINTER = 4
+
+LOG_PREFIXES = {
+    1 << 0: 'PROFILES NOTIFICATION: ',
+    1 << 1: 'PROFILES WARNING: ',
+    1 << 2: 'PROFILES ERROR: ',
+    1 << 3: 'PROFILES DEBUG: '
+}
+
+CONVERSION_PATTERN = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXcfFeEgGaAsp%])')
+
+
+def read_arguments(data):
+    arguments = []
+    offset = 0
+    while offset < len(data):
+        argument_type = data[offset]
+        offset += 1
+        if argument_type == ARGUMENT_INT:
+            arguments.append(struct.unpack_from('=q', data, offset)[0])
+            offset += 8
+        elif argument_type in (ARGUMENT_UINT, ARGUMENT_POINTER):
+            arguments.append(struct.unpack_from('=Q', data, offset)[0])
+            offset += 8
+        elif argument_type == ARGUMENT_DOUBLE:
+            arguments.append(struct.unpack_from('=d', data, offset)[0])
+            offset += 8
+        elif argument_type == ARGUMENT_STRING:
+            length = struct.unpack_from('=I', data, offset)[0]
+            offset += 4
+            arguments.append(data[offset:offset + length].decode('utf-8', errors='replace'))
+            offset += length
+        else:
+            Log.w(f'Unknown argument type {argument_type}, the message arguments are truncated')
+            break
+    return arguments
+
+
+def format_message(message_format, arguments):
+    # Each C conversion is rewritten with the Python formatting syntax, which ignores the length modifiers
+    arguments = list(arguments)
+
+    def next_argument():
+        return arguments.pop(0) if arguments else None
+
+    def replace(match):
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == '%':
+            return '%'
+        if width == '*':
+            width = str(next_argument())
+        if precision == '*':
+            precision = str(next_argument())
+        value = next_argument()
+        if value is None:
+            return match.group(0)
+
+        spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+        if conversion == 'p':
+            return (spec + 's') % hex(value)
+        if conversion in 'aA':
+            text = float.hex(float(value))
+            return (spec + 's') % (text.upper() if conversion == 'A' else text)
+        if conversion == 'c':
+            return (spec + 'c') % chr(value & 0xFF)
+        return (spec + conversion) % value
+
+    return CONVERSION_PATTERN.sub(replace, message_format)
+
+
+def read_header(data, offset):
+    if data[offset:offset + 4] != BINARY_LOG_MAGIC:
+        Log.e('The file is not a profiles layer binary log')
+        return False
+    version = struct.unpack_from('=I', data, offset + 4)[0] if offset + 8 <= len(data) else None
+    if version != BINARY_LOG_VERSION:
+        Log.e(f'Unsupported binary log version {version}, expected {BINARY_LOG_VERSION}')
+        return False
+    return True
+
+
+def decode_log(data, output):
+    if not read_header(data, 0):
+        return False
+
+    formats = {}
+    offset = 8
+    while offset + 8 <= len(data):
+        # When the log is not discarded, each layer run appends a new header and numbers its formats from zero
+        if data[offset:offset + 4] == BINARY_LOG_MAGIC:
+            if not read_header(data, offset):
+                return False
+            formats = {}
+            offset += 8
+            continue
+
+        kind, size = struct.unpack_from('=II', data, offset)
+        offset += 8
+        record = data[offset:offset + size]
+        offset += size
+        if len(record) < size:
+            Log.w('The last record of the binary log is incomplete')
+            break
+
+        if kind == RECORD_FORMAT:
+            format_id = struct.unpack_from('=I', record, 0)[0]
+            formats[format_id] = record[4:].decode('utf-8', errors='replace')
+        elif kind == RECORD_MESSAGE:
+            format_id, report, timestamp = struct.unpack_from('=IIq', record, 0)
+            if format_id not in formats:
+                Log.w(f'Message with the unknown format {format_id}')
+                continue
+            message = format_message(formats[format_id], read_arguments(record[16:]))
+            time = datetime.datetime.fromtimestamp(timestamp / 1e9).strftime('%Y-%m-%d %H:%M:%S.%f')
+            output.write(f'[{time}] {LOG_PREFIXES.get(report, LOG_PREFIXES[1 << 1])}{message}')
+        # Records of unknown kinds are skipped using their size
+    return True
+
+
+def main_log(args):
+    with open(args.input, 'rb') as input_file:
+        data = input_file.read()
+
+    if args.output is None:
+        decode_log(data, sys.stdout)
+    else:
+        with open(args.output, 'w', encoding='utf-8') as output_file:
+            decode_log(data, output_file)
@@ -0,0 +1,179 @@
+#!/usr/bin/python3
+#
+# Copyright (c) 2026-2026 Google, Inc.
+# Copyright (C) 2026-2026 Valve Corporation
+# Copyright (c) 2026-2026 LunarG, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License")
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Authors:
+# - Christophe Riccio <christophe@lunarg.com>
+
+import argparse
+import io
+from pathlib import Path
+import struct
+import sys
+import unittest
+
+scripts_dir = Path(__file__).resolve().parent.parent
+if str(scripts_dir) not in sys.path:
+    sys.path.insert(0, str(scripts_dir))
+
+from source.main_log import (
+    BINARY_LOG_MAGIC,
+    BINARY_LOG_VERSION,
+    RECORD_FORMAT,
+    RECORD_MESSAGE,
+    ARGUMENT_INT,
+    ARGUMENT_UINT,
+    ARGUMENT_DOUBLE,
+    ARGUMENT_STRING,
+    ARGUMENT_POINTER,
+    decode_log,
+    format_message,
+    read_arguments
+)
+
+REPORT_WARNING = 1 << 1
+REPORT_ERROR = 1 << 2
+
+
+# Encoder following the layout written by BinaryLogWriter in layer/profiles_settings.cpp
+def encode_header(version=BINARY_LOG_VERSION):
+    return BINARY_LOG_MAGIC + struct.pack('=I', version)
+
+
+def encode_format(format_id, message_format):
+    data = struct.pack('=I', format_id) + message_format.encode('utf-8')
+    return struct.pack('=II', RECORD_FORMAT, len(data)) + data
+
+
+def encode_argument(argument_type, value):
+    if argument_type == ARGUMENT_INT:
+        return struct.pack('=Bq', argument_type, value)
+    if argument_type in (ARGUMENT_UINT, ARGUMENT_POINTER):
+        return struct.pack('=BQ', argument_type, value)
+    if argument_type == ARGUMENT_DOUBLE:
+        return struct.pack('=Bd', argument_type, value)
+    encoded = value.encode('utf-8')
+    return struct.pack('=BI', argument_type, len(encoded)) + encoded
+
+
+def encode_message(format_id, report, arguments, timestamp=0):
+    data = struct.pack('=IIq', format_id, report, timestamp)
+    data += b''.join(encode_argument(argument_type, value) for argument_type, value in arguments)
+    return struct.pack('=II', RECORD_MESSAGE, len(data)) + data
+
+
+def decode(data):
+    output = io.StringIO()
+    result = decode_log(data, output)
+    # The timestamp depends on the local time zone
+    return result, [line.split('] ', 1)[1] for line in output.getvalue().splitlines(keepends=True)]
+
+
+class TestLog(unittest.TestCase):
+    def testReadArguments(self):
+        data = encode_argument(ARGUMENT_INT, -42) + encode_argument(ARGUMENT_UINT, 0xFFFFFFFFFF) + \
+            encode_argument(ARGUMENT_DOUBLE, 0.5) + encode_argument(ARGUMENT_STRING, 'string') + \
+            encode_argument(ARGUMENT_POINTER, 0x1000)
+        self.assertEqual(read_arguments(data), [-42, 0xFFFFFFFFFF, 0.5, 'string', 0x1000])
+
+    def testReadArgumentsUnknownType(self):
+        data = encode_argument(ARGUMENT_INT, 1) + bytes([0xFF]) + encode_argument(ARGUMENT_INT, 2)
+        self.assertEqual(read_arguments(data), [1])
+
+    def testFormatMessage(self):
+        self.assertEqual(format_message('%d %u %x %X %o', [-1, 2, 255, 255, 8]), '-1 2 ff FF 10')
+        self.assertEqual(format_message('%lld %zu %hhu', [-5, 6, 7]), '-5 6 7')
+        self.assertEqual(format_message('%.2f %e', [0.5, 1.0]), '0.50 1.000000e+00')
+        self.assertEqual(format_message('%s %c %%', ['text', ord('c')]), 'text c %')
+        self.assertEqual(format_message('%p', [0x1000]), '0x1000')
+        self.assertEqual(format_message('%*d|%-*.*f', [4, 7, 6, 1, 2.25]), '   7|2.2   ')
+
+    def testFormatMessageMissingArguments(self):
+        self.assertEqual(format_message('%s and %d', ['only']), 'only and %d')
+
+    def testDecodeLog(self):
+        data = encode_header()
+        data += encode_format(0, 'Device %s supports %u formats\n')
+        data += encode_message(0, REPORT_WARNING, [(ARGUMENT_STRING, 'GPU'), (ARGUMENT_UINT, 3)])
+        data += encode_format(1, 'Missing %s\n')
+        data += encode_message(1, REPORT_ERROR, [(ARGUMENT_STRING, 'feature')])
+        data += encode_message(0, REPORT_WARNING, [(ARGUMENT_STRING, 'CPU'), (ARGUMENT_UINT, 1)])
+
+        result, lines = decode(data)
+        self.assertTrue(result)
+        self.assertEqual(lines, [
+            'PROFILES WARNING: Device GPU supports 3 formats\n',
+            'PROFILES ERROR: Missing feature\n',
+            'PROFILES WARNING: Device CPU supports 1 formats\n'
+        ])
+
+    def testDecodeLogUnknownRecord(self):
+        data = encode_header()
+        data += encode_format(0, 'Message %d\n')
+        data += struct.pack('=II', 7, 4) + b'skip'
+        data += encode_message(3, REPORT_WARNING, [])
+        data += encode_message(0, REPORT_WARNING, [(ARGUMENT_INT, 1)])
+
+        result, lines = decode(data)
+        self.assertTrue(result)
+        self.assertEqual(lines, ['PROFILES WARNING: Message 1\n'])
+
+    def testDecodeLogAppendedRuns(self):
+        # Each run of the layer appends a header and numbers its formats from zero
+        data = encode_header()
+        data += encode_format(0, 'First %d\n')
+        data += encode_message(0, REPORT_WARNING, [(ARGUMENT_INT, 1)])
+        data += encode_header()
+        data += encode_format(0, 'Second %d\n')
+        data += encode_message(0, REPORT_WARNING, [(ARGUMENT_INT, 2)])
+
+        result, lines = decode(data)
+        self.assertTrue(result)
+        self.assertEqual(lines, ['PROFILES WARNING: First 1\n', 'PROFILES WARNING: Second 2\n'])
+
+    def testDecodeLogTruncated(self):
+        data = encode_header()
+        data += encode_format(0, 'Message %d\n')
+        data += encode_message(0, REPORT_WARNING, [(ARGUMENT_INT, 1)])
+        complete = len(data)
+        data += encode_message(0, REPORT_WARNING, [(ARGUMENT_INT, 2)])
+
+        for size in range(complete, len(data)):
+            result, lines = decode(data[:size])
+            self.assertTrue(result)
+            self.assertEqual(lines, ['PROFILES WARNING: Message 1\n'])
+
+    def testDecodeLogInvalidHeader(self):
+        self.assertFalse(decode(b'')[0])
+        self.assertFalse(decode(b'VPLX' + struct.pack('=I', BINARY_LOG_VERSION))[0])
+        self.assertFalse(decode(encode_header(BINARY_LOG_VERSION + 1))[0])
+
+        data = encode_header() + encode_header(BINARY_LOG_VERSION + 1)
+        self.assertFalse(decode(data)[0])
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument(
+        '--registry', '-r', action='store', required=True,
+        help='Use specified registry file instead of vk.xml.'
+    )
+
+    args, unparsed = parser.parse_known_args()
+
+    unittest.main(argv=[sys.argv[0]] + unparsed)